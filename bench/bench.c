@@ -0,0 +1,512 @@
+/**
+ * Soubor:    bench.c
+ * Datum:     2026/10/19
+ * Projekt:   Prevod cisla [www.joineset.com]
+ * Popis:     Mikrobenchmark jader aplikace nsc. Kazde jadro (cteni, kontrola
+ *            a vypis cislic, nasobeni, prevod mezi mocninami soustav
+ *            a Hornerovo schema) se meri samostatne pro ruzne velikosti
+ *            cisla a dvojice soustav. Vysledkem jsou takty na cislici
+ *            (percentily z opakovanych mereni po zahrati).
+ *            Pouziti: ./bench/bench [--reps=N] [--max=E] [--horner-max=E]
+ *                                   [--perf]  (nebo make bench)
+ */
+
+/*
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE  /* syscall, clock_gettime */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>  /* __rdtsc */
+#define HAVE_RDTSC 1
+#else
+#define HAVE_RDTSC 0
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#define HAVE_PERF 1
+#else
+#define HAVE_PERF 0
+#endif
+
+/** Jadra se meri primo, aplikace se vklada bez funkce main */
+#define NSC_NO_MAIN
+#include "../nsc.c"
+
+#define WARMUP 2  /**< pocet zahrivacich behu */
+#define DEFAULT_REPS 15  /**< vychozi pocet mereni */
+#define MAX_REPS 1000  /**< nejvetsi pocet mereni */
+#define DEFAULT_MAX_EXP 6  /**< vychozi nejvetsi cislo 10^6 cislic */
+#define MAX_EXP 8  /**< nejvetsi povolene cislo 10^8 cislic */
+#define DEFAULT_HORNER_MAX_EXP 4  /**< Horner je kvadraticky */
+#define PERF_COUNTERS 2  /**< cache-misses, branch-misses */
+
+
+/**
+ * Stav jednoho mereni - data pro jadro dane velikosti.
+ */
+typedef struct {
+  uint64_t digits;  /**< pocet cislic */
+  uint8_t fromBase;  /**< soustava dat */
+  uint8_t toBase;  /**< cilova soustava (jen prevody) */
+  char *chars;  /**< cislice jako znaky */
+  uint8_t *values;  /**< hodnoty cislic */
+  TNum num;  /**< cislo v seznamu (jen prevody) */
+} TCase;
+
+
+/**
+ * Popis jednoho jadra.
+ */
+typedef struct {
+  const char *name;  /**< nazev jadra */
+  uint8_t fromBase;  /**< vstupni soustava */
+  uint8_t toBase;  /**< vystupni soustava (0 = nejde o prevod) */
+  bool horner;  /**< kvadraticka slozitost, velikost omezuje --horner-max */
+  uint8_t (*prepare)(TCase *c);  /**< priprava dat pred kazdym merenim */
+  void (*run)(TCase *c);  /**< merena cast */
+} TKernel;
+
+
+/**
+ * Nastaveni z prikazove radky.
+ */
+typedef struct {
+  unsigned reps;  /**< pocet mereni */
+  unsigned maxExp;  /**< nejvetsi velikost 10^maxExp */
+  unsigned hornerMaxExp;  /**< nejvetsi velikost pro Hornerovo schema */
+  bool perf;  /**< merit hardwarove citace */
+} TBenchConfig;
+
+
+/**
+ * Znakove zastoupeni ciselnych sad
+ */
+const char numbers[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+
+
+/**
+ * Vrati aktualni cas v taktech (rdtsc) nebo v nanosekundach.
+ */
+uint64_t now(void)
+{
+#if HAVE_RDTSC
+  return __rdtsc();
+#else
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t) t.tv_sec * 1000000000u + (uint64_t) t.tv_nsec;
+#endif
+}
+
+
+/**
+ * Vrati nahodnou cislici cisla, prvni cislice neni nula.
+ */
+uint8_t randomDigit(uint8_t base, uint64_t position)
+{
+  if (position == 0)
+    return (uint8_t) (1 + rand() % (base - 1));
+  return (uint8_t) (rand() % base);
+}
+
+
+/**
+ * Pripravi pole znaku a hodnot cislic (jen jednou pro danou velikost).
+ * @return Kod z vyctu codes.
+ */
+uint8_t prepareArrays(TCase *c)
+{
+  if (c->values != NULL)
+    return EOK;
+
+  c->chars = malloc(c->digits);
+  c->values = malloc(c->digits * sizeof(uint8_t));
+  if (c->chars == NULL || c->values == NULL)
+    return EMEM;
+
+  for (uint64_t i = 0; i < c->digits; i++) {
+    c->values[i] = randomDigit(c->fromBase, i);
+    c->chars[i] = numbers[c->values[i]];
+  }
+
+  return EOK;
+}
+
+
+/**
+ * Pripravi nove cislo v seznamu (prevod seznam spotrebuje).
+ * @return Kod z vyctu codes.
+ */
+uint8_t prepareList(TCase *c)
+{
+  TListBlock *listBlock = NULL;  /**< ukazatel na aktualni blok */
+
+  destroyNum(&c->num);
+  inicializeNum(&c->num);
+  c->num.inputNumberBase = c->fromBase;
+  c->num.outputNumberBase = c->toBase;
+
+  for (uint64_t i = 0; i < c->digits; i++) {
+    if (listBlock == NULL || listBlock->numCount == NUM_BLOCK_SIZE) {
+      listBlock = addNewListBlock(&c->num.list, FIRST);
+      if (listBlock == NULL)  /* chyba pri alokaci pameti */
+        return EMEM;
+    }
+    listBlock->num[listBlock->numCount++] = randomDigit(c->fromBase, i);
+  }
+
+  return EOK;
+}
+
+
+/**
+ * Jadra nad polem cislic, zpracovavaji se po usecich jako pri cteni.
+ */
+void runParse(TCase *c)
+{
+  uint16_t count;  /**< pocet znaku v useku */
+
+  /* hodnoty se zapisuji do c->values (tytez, ktere tam uz jsou); zapis do
+     lokalniho pole, ktere se dale necte, by prekladac smel vypustit */
+  for (uint64_t i = 0; i < c->digits; i += count) {
+    count = (c->digits - i < INPUT_BUFFER_SIZE) ?
+            (uint16_t) (c->digits - i) : INPUT_BUFFER_SIZE;
+    count = countDigitChars(c->chars + i, count);
+    parseDigits(c->chars + i, count, c->values + i);
+  }
+}
+
+void runValidate(TCase *c)
+{
+  volatile uint8_t max = 0;  /**< vysledek nesmi prekladac zahodit */
+  uint16_t count;  /**< pocet cislic v useku */
+  uint8_t digit;  /**< nejvetsi cislice useku */
+
+  for (uint64_t i = 0; i < c->digits; i += count) {
+    count = (c->digits - i < INPUT_BUFFER_SIZE) ?
+            (uint16_t) (c->digits - i) : INPUT_BUFFER_SIZE;
+    digit = maxDigit(c->values + i, count);
+    if (digit > max)
+      max = digit;
+  }
+}
+
+void runFormat(TCase *c)
+{
+  uint16_t count;  /**< pocet cislic v useku */
+
+  for (uint64_t i = 0; i < c->digits; i += count) {
+    count = (c->digits - i < INPUT_BUFFER_SIZE) ?
+            (uint16_t) (c->digits - i) : INPUT_BUFFER_SIZE;
+    formatDigits(c->values + i, count, c->chars + i);
+  }
+}
+
+void runMultiply(TCase *c)
+{
+  uint16_t count;  /**< pocet cislic v useku */
+  uint32_t carry = 0;  /**< prenos mezi useky */
+
+  /* cislice zustavaji v soustave fromBase, nasobi se jeji hodnotou */
+  for (uint64_t i = 0; i < c->digits; i += count) {
+    count = (c->digits - i < INPUT_BUFFER_SIZE) ?
+            (uint16_t) (c->digits - i) : INPUT_BUFFER_SIZE;
+    carry = multiplyDigits(c->values + i, count, c->fromBase, c->fromBase,
+                           carry);
+  }
+}
+
+
+/**
+ * Prevody nad seznamem (konverze vysledek nekontroluje, meri jen cas).
+ */
+void runConvert(TCase *c)
+{
+  convertNumber(&c->num);
+}
+
+
+/**
+ * Merena jadra. Cteni, kontrola, vypis a nasobeni nezavisi na dvojici
+ * soustav, prevody se meri pro typicke dvojice.
+ */
+const TKernel kernels[] = {
+  {"parse", 36, 0, false, prepareArrays, runParse},
+  {"validate", 36, 0, false, prepareArrays, runValidate},
+  {"format", 36, 0, false, prepareArrays, runFormat},
+  {"multiply", 10, 0, false, prepareArrays, runMultiply},
+  {"power", 2, 16, false, prepareList, runConvert},
+  {"power", 16, 2, false, prepareList, runConvert},
+  {"power", 2, 8, false, prepareList, runConvert},
+  {"power", 8, 2, false, prepareList, runConvert},
+  {"power", 3, 27, false, prepareList, runConvert},
+  {"power", 27, 3, false, prepareList, runConvert},
+  {"power", 2, 32, false, prepareList, runConvert},
+  {"power", 32, 2, false, prepareList, runConvert},
+  {"horner", 10, 2, true, prepareList, runConvert},
+  {"horner", 2, 10, true, prepareList, runConvert},
+  {"horner", 10, 16, true, prepareList, runConvert},
+  {"horner", 16, 10, true, prepareList, runConvert},
+  {"horner", 10, 7, true, prepareList, runConvert},
+  {"horner", 36, 10, true, prepareList, runConvert},
+};
+
+#define KERNELS_COUNT (sizeof(kernels) / sizeof(kernels[0]))
+
+
+#if HAVE_PERF
+/**
+ * Otevre hardwarove citace (cache-misses a branch-misses) pro tento proces.
+ * @param fds Pole pro popisovace citacu.
+ * @return true pri uspechu.
+ */
+bool openPerf(int fds[PERF_COUNTERS])
+{
+  const uint64_t configs[PERF_COUNTERS] = {
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES,
+  };
+  struct perf_event_attr attr;
+
+  for (int i = 0; i < PERF_COUNTERS; i++) {
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = configs[i];
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    fds[i] = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fds[i] == -1) {
+      while (i-- > 0)
+        close(fds[i]);
+      return false;
+    }
+  }
+
+  return true;
+}
+#endif
+
+
+/**
+ * Porovnani dvou hodnot typu uint64_t pro qsort.
+ */
+int compareUint64(const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *) a;
+  uint64_t y = *(const uint64_t *) b;
+
+  return (x > y) - (x < y);
+}
+
+
+/**
+ * Vrati percentil serazenych hodnot (metoda nejblizsiho poradi).
+ */
+uint64_t percentile(const uint64_t *sorted, unsigned count, unsigned p)
+{
+  unsigned rank = (p * count + 99) / 100;
+
+  return sorted[(rank == 0) ? 0 : rank - 1];
+}
+
+
+/**
+ * Zmeri jedno jadro pro jednu velikost a vypise radek tabulky.
+ * @param fds Popisovace hardwarovych citacu nebo NULL.
+ * @return Kod z vyctu codes.
+ */
+uint8_t measure(const TKernel *kernel, uint64_t digits,
+                const TBenchConfig *config, const int *fds)
+{
+  uint64_t times[MAX_REPS];  /**< namerene casy */
+  uint64_t counts[PERF_COUNTERS][MAX_REPS];  /**< hodnoty citacu */
+  uint64_t start;  /**< pocatek mereni */
+  uint8_t state = EOK;  /**< navratovy kod funkci */
+  TCase c;  /**< data pro jadro */
+
+  c.digits = digits;
+  c.fromBase = kernel->fromBase;
+  c.toBase = kernel->toBase;
+  c.chars = NULL;
+  c.values = NULL;
+  inicializeNum(&c.num);
+
+  for (unsigned r = 0; r < WARMUP + config->reps && state == EOK; r++) {
+    state = kernel->prepare(&c);
+    if (state != EOK)
+      break;
+
+#if HAVE_PERF
+    for (int k = 0; fds != NULL && k < PERF_COUNTERS; k++) {
+      ioctl(fds[k], PERF_EVENT_IOC_RESET, 0);
+      ioctl(fds[k], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+
+    start = now();
+    kernel->run(&c);
+    if (r >= WARMUP)
+      times[r - WARMUP] = now() - start;
+
+#if HAVE_PERF
+    for (int k = 0; fds != NULL && k < PERF_COUNTERS; k++) {
+      ioctl(fds[k], PERF_EVENT_IOC_DISABLE, 0);
+      if (r >= WARMUP &&
+          read(fds[k], &counts[k][r - WARMUP], sizeof(uint64_t)) !=
+          sizeof(uint64_t)) {
+        counts[k][r - WARMUP] = 0;
+      }
+    }
+#endif
+  }
+
+  free(c.chars);
+  free(c.values);
+  destroyNum(&c.num);
+  if (state != EOK)
+    return state;
+
+  qsort(times, config->reps, sizeof(uint64_t), compareUint64);
+
+  char pair[8];  /**< dvojice soustav */
+  if (kernel->toBase != 0)
+    snprintf(pair, sizeof(pair), "%u>%u", kernel->fromBase, kernel->toBase);
+  else
+    snprintf(pair, sizeof(pair), "%u", kernel->fromBase);
+
+  printf("%-9s %-6s %10llu %9.3f %9.3f %9.3f %9.3f", kernel->name, pair,
+         (unsigned long long) digits,
+         (double) times[0] / digits,
+         (double) percentile(times, config->reps, 50) / digits,
+         (double) percentile(times, config->reps, 90) / digits,
+         (double) percentile(times, config->reps, 99) / digits);
+
+  if (fds != NULL) {  /* mediany citacu na 1000 cislic */
+    for (int k = 0; k < PERF_COUNTERS; k++) {
+      qsort(counts[k], config->reps, sizeof(uint64_t), compareUint64);
+      printf(" %9.3f",
+             1000.0 * percentile(counts[k], config->reps, 50) / digits);
+    }
+  }
+  printf("\n");
+  fflush(stdout);
+
+  return EOK;
+}
+
+
+/**
+ * Nacte nastaveni z prikazove radky.
+ * @return Kod z vyctu codes.
+ */
+uint8_t readBenchArguments(int argc, char *argv[], TBenchConfig *config)
+{
+  const char *value;  /**< hodnota parametru */
+
+  config->reps = DEFAULT_REPS;
+  config->maxExp = DEFAULT_MAX_EXP;
+  config->hornerMaxExp = DEFAULT_HORNER_MAX_EXP;
+  config->perf = false;
+
+  for (int i = 1; i < argc; i++) {
+    if ((value = skipPrefix(argv[i], "--reps=")) != NULL)
+      config->reps = (unsigned) atoi(value);
+    else if ((value = skipPrefix(argv[i], "--max=")) != NULL)
+      config->maxExp = (unsigned) atoi(value);
+    else if ((value = skipPrefix(argv[i], "--horner-max=")) != NULL)
+      config->hornerMaxExp = (unsigned) atoi(value);
+    else if (strcmp(argv[i], "--perf") == 0)
+      config->perf = true;
+    else
+      return EPARAM;
+  }
+
+  if (config->reps == 0 || config->reps > MAX_REPS ||
+      config->maxExp < 2 || config->maxExp > MAX_EXP ||
+      config->hornerMaxExp < 2 || config->hornerMaxExp > MAX_EXP) {
+    return EPARAM;
+  }
+
+  return EOK;
+}
+
+
+
+/********************************** main() **********************************/
+
+int main(int argc, char *argv[])
+{
+  TBenchConfig config;  /**< nastaveni z prikazove radky */
+  int fds[PERF_COUNTERS];  /**< hardwarove citace */
+  const int *perf = NULL;  /**< citace, pokud jsou k dispozici */
+  uint8_t state;  /**< navratovy kod funkci */
+
+  state = readBenchArguments(argc, argv, &config);
+  if (state != EOK) {
+    printError(state);
+    return state;
+  }
+
+  if (config.perf) {
+#if HAVE_PERF
+    if (openPerf(fds))
+      perf = fds;
+#endif
+    if (perf == NULL)
+      fprintf(stderr, "perf_event_open is not available, "
+              "hardware counters are disabled.\n");
+  }
+
+  srand(1);  /* stejna data pri kazdem spusteni */
+
+  printf("# block size %u, warmup %d, repetitions %u, unit: %s per digit\n",
+         (unsigned) NUM_BLOCK_SIZE, WARMUP, config.reps,
+         HAVE_RDTSC ? "TSC cycles" : "ns");
+  printf("%-9s %-6s %10s %9s %9s %9s %9s", "kernel", "bases", "digits",
+         "min", "p50", "p90", "p99");
+  if (perf != NULL)
+    printf(" %9s %9s", "cmiss/kd", "bmiss/kd");
+  printf("\n");
+
+  for (size_t k = 0; k < KERNELS_COUNT; k++) {
+    unsigned maxExp = kernels[k].horner ? config.hornerMaxExp
+                                        : config.maxExp;
+    uint64_t digits = 100;  /**< velikost 10^2 az 10^maxExp */
+
+    for (unsigned e = 2; e <= maxExp; e++, digits *= 10) {
+      state = measure(&kernels[k], digits, &config, perf);
+      if (state != EOK) {
+        printError(state);
+        destroySpareListBlocks();
+        return state;
+      }
+    }
+  }
+
+  destroySpareListBlocks();
+
+  return EOK;
+}
@@ -9,6 +9,8 @@
  *            pro vypis standardni vystup.
  *            Format: [XXXX]Z1=Z2
  *            Napr.: [1012222121310101]4=32 (prevod ze 4-kove do 32 soustavy)
+ *            Vystupnich soustav muze byt vice: [XXXX]Z1=Z2,Z3,...
+ *            Soustavy mohou byt i pred cislem: Z1=Z2,Z3,...:[XXXX]
  *            Je mozne pouzit knihovni funkce, avsak pouze
  *            read, write, malloc a free.
  *            http://www.joineset.cz/prevod_cisla.html
@@ -36,6 +38,11 @@
 #include <stdint.h>  /* uint*_t */
 #include <stdbool.h>  /* bool */
 
+#ifdef HAVE_TUNE_H
+#include "tune.h"  /* prahy vygenerovane pomoci 'make tune' */
+#endif
+
+
 #define STDIN 0   /**< standardni vstup */
 #define STDOUT 1  /**< standardni vystup */
 #define STDERR 2  /**< standardni chybovy vystup */
@@ -44,10 +51,56 @@
 #define FIRST true
 #define LAST false
 
+#define INPUT_BUFFER_SIZE 4096  /**< velikost nacitaciho a vypisoveho bufferu */
+#define OUTPUT_BUFFER_SIZE 1048576  /**< nejvetsi usek vystupu (jeden write) */
+#define INPUT_EOF (-1)  /**< readChar: konec vstupu */
+#define INPUT_ERROR (-2)  /**< readChar: chyba pri cteni */
+
+/**
+ * Vice verzi vykonnych smycek (jader) pro ruzne instrukcni sady procesoru.
+ * Prekladac vytvori varianty pro AVX-512, AVX2 i obecny procesor a vhodnou
+ * vybere jednou pri startu podle cpuid. Lze vypnout pomoci -DNSC_NO_DISPATCH.
+ * Clang (starsi verze) atribut target_clones nezna, prekladaji se jen obecne.
+ */
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && \
+    !defined(NSC_NO_DISPATCH)
+#define KERNEL __attribute__((target_clones("avx512f", "avx2", "default")))
+#define KERNEL_DISPATCH 1
+#else
+#define KERNEL
+#define KERNEL_DISPATCH 0
+#endif
+
 #define MIN_NUMBER_BASE 2   /**< minimalni ciselna soustava (min. je 2) */
 #define MAX_NUMBER_BASE 36  /**< maximalni ciselna soustava (max. je 36) */
-
+#define MAX_POWER 5  /**< nejvyssi mocnina mezi soustavami (2^5 = 32) */
+#define MAX_DECIMAL_DIGITS 18  /**< nejdelsi cislo parametru (--digits) */
+#define MAX_LEADING_DIGITS 1000  /**< nejvice nejvyssich cislic (--leading) */
+#define LEADING_GUARD_DIGITS 16  /**< cislice navic pri odhadu (--leading) */
+#define LEADING_ROUNDS 3  /**< nejvice pokusu o odhad (--leading) */
+#define MAX_SHARDS 64  /**< nejvice souboru s castmi cisla (--shard-fds) */
+#define VERIFY_PRIMES 2  /**< pocet prvocisel kontroly (--verify) */
+#define VERIFY_MASK ((UINT64_C(1) << 61) - 1)  /**< 2^61 - 1 */
+
+#ifndef NUM_BLOCK_SIZE
 #define NUM_BLOCK_SIZE 600  /**< velikost bloku cisel (cislo delitelne 60) */
+#endif
+#define MAX_NUM_BLOCK_SIZE 60000  /**< maximalni velikost bloku cisel */
+
+#if NUM_BLOCK_SIZE % 60 != 0 || NUM_BLOCK_SIZE > MAX_NUM_BLOCK_SIZE
+#error "NUM_BLOCK_SIZE must be a multiple of 60 and at most 60000"
+#endif
+
+#define BINARY_MAGIC "NSCL"  /**< identifikace binarniho formatu (4 znaky) */
+#define BINARY_HEADER_SIZE 12  /**< magic (4 B) + pocet limbu (8 B, LE) */
+#define LIMB_SIZE 8  /**< velikost limbu v bajtech (64 bitu, LE) */
+#define BINARY_NUMBER_BASE 16  /**< soustava pro ulozeni binarniho cisla */
+#define BINARY_BUFFER_SIZE 4096  /**< buffer binarnich dat (nasobek 8) */
+
+/** maximalni pocet vystupnich soustav v jednom vyrazu ([XXX]Z1=Z2,Z3,...) */
+#define MAX_OUTPUT_BASES (MAX_NUMBER_BASE - MIN_NUMBER_BASE + 1)
+/** maximalni delka zapisu soustav za cislem (2 + '=' + 35 * (2 + ',')) */
+#define MAX_BASES_LENGTH 128
 
 
 /**
@@ -55,12 +108,10 @@
  * Obousmerne vazany seznam.
  */
 typedef struct listBlock {
-/* TODO uint16_t je prilis velky datovy typ = plytvani pameti,
-        nejvetsi cislo, ktere potrebujeme ulozit je 35 * 36 */
-  uint16_t num[NUM_BLOCK_SIZE];  /**< blok cisel */
   uint16_t numCount;  /**< pocet ulozenych cisel */
   struct listBlock *prev;
   struct listBlock *next;
+  uint8_t num[NUM_BLOCK_SIZE];  /**< blok cisel (cislice mensi nez 36) */
 } TListBlock;
 
 
@@ -80,10 +131,48 @@ typedef struct {
 typedef struct {
   uint8_t inputNumberBase;  /**< ve ktere soustave je cislo */
   uint8_t outputNumberBase;  /**< do ktere soustavy se ma konvertovat */
+  uint8_t outputNumberBases[MAX_OUTPUT_BASES];  /**< vystupni soustavy */
+  uint8_t outputNumberBasesCount;  /**< pocet vystupnich soustav */
   TList list;  /**< seznam obsahujici vstupni cislo */
+  bool storeList;  /**< ukladat vstupni cislo do seznamu list */
+  TList outputLists[MAX_OUTPUT_BASES];  /**< cisla prevadena jiz pri cteni */
+  uint64_t digitsLimit;  /**< pocitat jen tolik nizsich cislic (0 = vse) */
+  bool verify;  /**< kontrolovat vysledek pomoci zbytku (--verify) */
+  uint64_t residues[VERIFY_PRIMES];  /**< zbytky vstupniho cisla */
 } TNum;
 
 
+/**
+ * Nastaveni zadane parametry prikazove radky.
+ */
+typedef struct {
+  bool binaryInput;  /**< vstup v binarnim formatu (--binary-input) */
+  bool binaryOutput;  /**< vystup v binarnim formatu (--binary-output) */
+  bool cpuFeatures;  /**< vypsat podporovane sady (--cpu-features) */
+  bool batch;  /**< vice vyrazu, jeden na radek (--batch) */
+  uint8_t inputNumberBase;  /**< vstupni soustava z --from (0 = nezadano) */
+  uint8_t outputNumberBases[MAX_OUTPUT_BASES];  /**< soustavy z --to */
+  uint8_t outputNumberBasesCount;  /**< pocet soustav z --to (0 = nezadano) */
+  uint64_t digitsStart;  /**< prvni vypsana cislice od nejnizsi (--digits) */
+  uint64_t digitsLength;  /**< pocet vypsanych cislic (0 = cele cislo) */
+  uint16_t leadingDigits;  /**< jen nejvyssi cislice a delka (--leading) */
+  bool verify;  /**< kontrola vysledku pomoci zbytku (--verify) */
+  int shardFds[MAX_SHARDS];  /**< deskriptory casti cisla (--shard-fds) */
+  uint8_t shardsCount;  /**< pocet casti cisla (0 = standardni vstup) */
+} TConfig;
+
+
+/**
+ * Cislo s plovouci radovou carkou pro odhad nejvyssich cislic (--leading).
+ * Hodnota je mantisa * Z2^exponent, mantisa ma pevny pocet cislic
+ * (presnost) a jeji nejvyssi cislice neni nulova.
+ */
+typedef struct {
+  uint16_t *num;  /**< cislice mantisy od nejvyssiho radu */
+  int64_t exponent;  /**< exponent vystupni soustavy */
+} TFloat;
+
+
 
 /**
  * Kody stavu (predevsim chybovych).
@@ -96,6 +185,9 @@ enum codes {
   EINPUTNUMBER,  /**< Chybne vstupni cislo */
   EINPUTBASE,    /**< Vstupni ciselna soustava je mimo rozsah */
   EOUTPUTBASE,   /**< Vystupni ciselna soustave je mimo rozsah */
+  EPARAM,        /**< Chybne parametry prikazove radky */
+  EWRITE,        /**< Chyba pri zapisu na vystup */
+  EVERIFY,       /**< Kontrola vysledku selhala */
   EUNKNOWN,      /**< Neznama chyba */
 };
 
@@ -111,6 +203,9 @@ const char *MSG[] = {
   "ERROR! Bad input number.\n",                 /* EINPUTNUMBER */
   "ERROR! Input radix is out of range.\n",      /* EINPUTBASE */
   "ERROR! Output radix is out of range.\n",     /* EOUTPUTBASE */
+  "ERROR! Bad command line arguments.\n",       /* EPARAM */
+  "ERROR! Write to standard output failed.\n",  /* EWRITE */
+  "ERROR! Verification of the result failed.\n",  /* EVERIFY */
   "ERROR! Unknown error.\n",                    /* EUNKNOWN */
 };
 
@@ -127,6 +222,41 @@ const char num2char[] = {
 };
 
 
+/**
+ * Konstanty c prvocisel p = 2^61 - c, modulo kterymi se porovnava vstupni
+ * a vystupni cislo (--verify).
+ */
+const uint64_t verifyOffsets[VERIFY_PRIMES] = {1, 31};
+
+
+
+/**
+ * Zasobnik uvolnenych bloku (propojenych pres ukazatel next).
+ * Spotrebovane bloky vstupniho seznamu se tak pouziji jako bloky vystupniho
+ * seznamu a pametova spicka prevodu zustava blizko velikosti vstupu.
+ */
+TListBlock *spareListBlocks = NULL;
+
+/**
+ * Vstupni buffer sdileny vsemi funkcemi cteni textoveho vstupu. Nactena data
+ * za koncem vyrazu v nem zustanou pro dalsi vyraz (--batch).
+ */
+struct {
+  char buf[INPUT_BUFFER_SIZE];  /**< nactena data */
+  uint16_t start;  /**< prvni nezpracovany znak */
+  uint16_t end;  /**< konec nactenych dat */
+} inputBuffer;
+
+/**
+ * Vystupni buffer textoveho vypisu. Vypisuje se az pri zaplneni nebo po
+ * zpracovani vyrazu (po davce vyrazu), kratke vysledky tak nestoji write.
+ */
+struct {
+  char buf[OUTPUT_BUFFER_SIZE];  /**< data pro vypis */
+  size_t length;  /**< pocet znaku v bufferu */
+} outputBuffer;
+
+
 
 /**
  * Vypise chybove hlaseni na standardni chybovy vystup.
@@ -145,17 +275,356 @@ void printError(uint8_t error)
 }
 
 
+/**
+ * Zapise cely buffer na standardni vystup (write muze zapsat jen cast).
+ * @param buf Buffer se zapisovanymi daty.
+ * @param length Pocet bajtu k zapsani.
+ * @return Kod z vyctu codes.
+ */
+uint8_t writeFully(const void *buf, size_t length)
+{
+  const char *data = buf;  /**< dosud nezapsana data */
+  ssize_t writtenBytes;  /**< pocet bajtu zapsanych jednim volanim write */
+
+  while (length > 0) {
+    writtenBytes = write(STDOUT, data, length);
+    if (writtenBytes <= 0)  /* chyba pri zapisu */
+      return EWRITE;
+    data += writtenBytes;
+    length -= (size_t) writtenBytes;
+  }
+
+  return EOK;
+}
+
+
+/**
+ * Doplni vstupni buffer, pokud uz v nem nejsou zadna nezpracovana data.
+ * @return Pocet nezpracovanych znaku, 0 na konci vstupu, -1 pri chybe.
+ */
+int32_t fillInput(void)
+{
+  if (inputBuffer.start == inputBuffer.end) {
+    ssize_t readBytes = read(STDIN, inputBuffer.buf, INPUT_BUFFER_SIZE);
+    if (readBytes == -1)  /* chyba pri cteni ze vstupu */
+      return -1;
+    inputBuffer.start = 0;
+    inputBuffer.end = (uint16_t) readBytes;
+  }
+
+  return inputBuffer.end - inputBuffer.start;
+}
+
+
+/**
+ * Nacte jeden znak ze vstupu.
+ * @return Nacteny znak, INPUT_EOF na konci vstupu, INPUT_ERROR pri chybe.
+ */
+int readChar(void)
+{
+  int32_t available = fillInput();  /**< pocet nezpracovanych znaku */
+
+  if (available == -1)  /* chyba pri cteni ze vstupu */
+    return INPUT_ERROR;
+  if (available == 0)  /* konec vstupu */
+    return INPUT_EOF;
+
+  return (unsigned char) inputBuffer.buf[inputBuffer.start++];
+}
+
+
+/**
+ * Vrati posledni znak nacteny funkci readChar zpet na vstup.
+ */
+void unreadChar(void)
+{
+  inputBuffer.start--;
+}
+
+
 /**
  * Vycisti vstupni buffer
+ * @param line Preskocit jen zbytek radku vcetne '\n' (--batch).
  */
-void clearBuffer(void)
+void clearBuffer(bool line)
 {
+  int ch;  /**< nacteny znak */
+
+  if (line) {
+    do {
+      ch = readChar();
+    } while (ch != '\n' && ch != INPUT_EOF && ch != INPUT_ERROR);
+    return;
+  }
+
   char buf[100];
+  inputBuffer.start = inputBuffer.end;
   while (read(STDIN, &buf, 100) == 1)
     ;
 }
 
 
+/**
+ * Vypise obsah vystupniho bufferu.
+ * @return Kod z vyctu codes.
+ */
+uint8_t flushOutput(void)
+{
+  uint8_t state = writeFully(outputBuffer.buf, outputBuffer.length);
+
+  outputBuffer.length = 0;
+
+  return state;
+}
+
+
+/**
+ * Overi, jestli retezec zacina danou predponou.
+ * @param str Retezec.
+ * @param prefix Predpona.
+ * @return Ukazatel za predponu v retezci nebo NULL, pokud predpona chybi.
+ */
+const char *skipPrefix(const char *str, const char *prefix)
+{
+  while (*prefix != '\0') {
+    if (*str++ != *prefix++)
+      return NULL;
+  }
+
+  return str;
+}
+
+
+/**
+ * Spocita delku retezce (max. UINT16_MAX).
+ * @param str Retezec.
+ * @return Pocet znaku retezce.
+ */
+uint16_t stringLength(const char *str)
+{
+  uint16_t length = 0;  /**< pocet znaku */
+
+  while (str[length] != '\0' && length < UINT16_MAX)
+    length++;
+
+  return length;
+}
+
+
+/**
+ * Spocita delku useku znaku 0-9 a A-Z na zacatku bufferu.
+ * @param buf Buffer se znaky.
+ * @param length Pocet znaku v bufferu.
+ * @return Pocet znaku cislic pred prvnim jinym znakem.
+ */
+uint16_t countDigitChars(const char *buf, uint16_t length)
+{
+  uint16_t i = 0;  /**< iterator cyklu */
+
+  while (i < length && ((buf[i] >= '0' && buf[i] <= '9') ||
+                        (buf[i] >= 'A' && buf[i] <= 'Z'))) {
+    i++;
+  }
+
+  return i;
+}
+
+
+/**
+ * Prevede znaky cislic (0-9, A-Z) na jejich hodnoty.
+ * Funkce NEOVERUJE platnost znaku (viz countDigitChars)!
+ * @param buf Buffer se znaky.
+ * @param count Pocet znaku.
+ * @param num Pole pro hodnoty cislic.
+ */
+KERNEL
+void parseDigits(const char *buf, uint16_t count, uint8_t *num)
+{
+  for (uint16_t i = 0; i < count; i++)
+    num[i] = (uint8_t) (buf[i] - '0' - (buf[i] > '9') * ('A' - '9' - 1));
+}
+
+
+/**
+ * Najde nejvetsi cislici (pro kontrolu vstupni soustavy).
+ * @param num Pole cislic.
+ * @param count Pocet cislic.
+ * @return Nejvetsi cislice, 0 pro prazdne pole.
+ */
+KERNEL
+uint8_t maxDigit(const uint8_t *num, uint16_t count)
+{
+  uint8_t max = 0;  /**< nejvetsi nalezena cislice */
+
+  for (uint16_t i = 0; i < count; i++)
+    max = (num[i] > max) ? num[i] : max;
+
+  return max;
+}
+
+
+/**
+ * Prevede hodnoty cislic na znaky (0-9, A-Z).
+ * @param num Pole cislic.
+ * @param count Pocet cislic.
+ * @param buf Buffer pro znaky.
+ */
+KERNEL
+void formatDigits(const uint8_t *num, uint16_t count, char *buf)
+{
+  for (uint16_t i = 0; i < count; i++)
+    buf[i] = (char) (num[i] + '0' + (num[i] > 9) * ('A' - '9' - 1));
+}
+
+
+/**
+ * Vynasobi cislice konstantou a pricte prenos, od nejnizsiho radu (konec
+ * pole). Deleni soustavou nahrazuje nasobeni prevracenou hodnotou
+ * 2^16 / base zaokrouhlenou nahoru, pro mezivysledky pod 36 * 36 je presne.
+ * @param num Pole cislic (mensich nez base).
+ * @param count Pocet cislic.
+ * @param factor Nasobitel (nejvyse 36).
+ * @param base Soustava cislic.
+ * @param carry Prenos do nejnizsiho radu (mensi nez factor).
+ * @return Prenos z nejvyssiho radu (mensi nez factor).
+ */
+KERNEL
+uint32_t multiplyDigits(uint8_t *num, uint16_t count, uint8_t factor,
+                        uint8_t base, uint32_t carry)
+{
+  uint32_t inverse = 65536 / base + 1;  /**< prevracena hodnota soustavy */
+  uint32_t value;  /**< cislice krat nasobitel plus prenos */
+
+  for (uint16_t i = count; i > 0; i--) {
+    value = (uint32_t) num[i - 1] * factor + carry;
+    carry = (value * inverse) >> 16;
+    num[i - 1] = (uint8_t) (value - carry * base);
+  }
+
+  return carry;
+}
+
+
+/**
+ * Vynasobi dve cisla modulo prvocislo p = 2^61 - c. Soucin se sklada
+ * z 32bitovych polovin, neni tedy treba 128bitovy datovy typ.
+ * @param a Prvni cinitel (mensi nez 2^61).
+ * @param b Druhy cinitel (mensi nez 2^61).
+ * @param offset Konstanta c prvocisla (nejvyse 63).
+ * @return a * b mod p.
+ */
+uint64_t multiplyModulo(uint64_t a, uint64_t b, uint64_t offset)
+{
+  uint64_t modulus = VERIFY_MASK - offset + 1;  /**< prvocislo p */
+  uint64_t low, high, middle;  /**< casti 128bitoveho soucinu */
+  uint64_t part;  /**< horni cast soucinu (nad 2^61) krat c */
+
+  /** Soucin high * 2^64 + low */
+  low = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+  middle = (a >> 32) * (b & 0xFFFFFFFF) + (a & 0xFFFFFFFF) * (b >> 32);
+  high = (a >> 32) * (b >> 32) + (middle >> 32);
+  middle <<= 32;
+  low += middle;
+  high += (low < middle);
+
+  /** Redukce: x * 2^61 + y je kongruentni x * c + y */
+  high = (high << 3) | (low >> 61);  /* x < 2^61 */
+  low &= VERIFY_MASK;
+  part = (high >> 32) * offset;  /* x * c = part * 2^32 + ... */
+  low += ((part & 0x1FFFFFFF) << 32) + (part >> 29) * offset +
+         (high & 0xFFFFFFFF) * offset;
+  low = (low & VERIFY_MASK) + (low >> 61) * offset;
+
+  while (low >= modulus)
+    low -= modulus;
+
+  return low;
+}
+
+
+/**
+ * Pripocte cislice ke zbytkum cisla po deleni prvocisly (--verify).
+ * Cislice se zpracuji po usecich, jejichz hodnota i mocnina soustavy se
+ * vejde pod 2^61, na usek tak pripada jedno nasobeni pro kazde prvocislo.
+ * @param residues Zbytky cisla (VERIFY_PRIMES prvku).
+ * @param num Cislice od nejvyssiho radu.
+ * @param count Pocet cislic.
+ * @param base Soustava cislic.
+ */
+void residueDigits(uint64_t *residues, const uint8_t *num, uint16_t count,
+                   uint8_t base)
+{
+  uint64_t value;  /**< hodnota useku */
+  uint64_t power;  /**< base^(pocet cislic useku) */
+  uint16_t i = 0;  /**< pozice v cislicich */
+
+  while (i < count) {
+    value = 0;
+    for (power = 1; i < count && power <= VERIFY_MASK / MAX_NUMBER_BASE;
+         power *= base) {
+      value = (value * base) + num[i++];
+    }
+
+    for (uint8_t k = 0; k < VERIFY_PRIMES; k++) {
+      residues[k] = multiplyModulo(residues[k], power, verifyOffsets[k]) +
+                    value;
+      while (residues[k] > VERIFY_MASK - verifyOffsets[k])
+        residues[k] -= VERIFY_MASK - verifyOffsets[k] + 1;
+    }
+  }
+}
+
+
+/**
+ * Spocita zbytky cisla ulozeneho v seznamu (--verify).
+ * @param residues Zbytky cisla (VERIFY_PRIMES prvku).
+ * @param list Ukazatel na seznam s cislem.
+ * @param base Soustava cisla.
+ */
+void residueList(uint64_t *residues, const TList *list, uint8_t base)
+{
+  for (uint8_t k = 0; k < VERIFY_PRIMES; k++)
+    residues[k] = 0;
+
+  for (const TListBlock *listBlock = list->first; listBlock != NULL;
+       listBlock = listBlock->next) {
+    residueDigits(residues, listBlock->num, listBlock->numCount, base);
+  }
+}
+
+
+/**
+ * Vypise instrukcni sady podporovane procesorem a prelozene varianty jader.
+ * Kterou variantu zvoli zavadec (ifunc), se primo zjistit neda.
+ */
+void printCpuFeatures(void)
+{
+  const char *features[] = {"avx2", "avx512f", "bmi2", "adx"};
+  const char *supported[] = {"unknown", "unknown", "unknown", "unknown"};
+
+#if defined(__GNUC__) && defined(__x86_64__)
+  __builtin_cpu_init();
+  supported[0] = __builtin_cpu_supports("avx2") ? "yes" : "no";
+  supported[1] = __builtin_cpu_supports("avx512f") ? "yes" : "no";
+  supported[2] = __builtin_cpu_supports("bmi2") ? "yes" : "no";
+  supported[3] = __builtin_cpu_supports("adx") ? "yes" : "no";
+#endif
+
+  write(STDOUT, "supported features:\n", 20);
+  for (uint8_t i = 0; i < sizeof(features) / sizeof(features[0]); i++) {
+    write(STDOUT, features[i], stringLength(features[i]));
+    write(STDOUT, ": ", 2);
+    write(STDOUT, supported[i], stringLength(supported[i]));
+    write(STDOUT, "\n", 1);
+  }
+
+  if (KERNEL_DISPATCH)
+    write(STDOUT, "kernel variants: avx512f avx2 default\n", 38);
+  else
+    write(STDOUT, "kernel variants: default (dispatch disabled)\n", 45);
+}
+
+
 /**
  * Inicializuje ukazatele na seznam.
  * @param list Ukazatel na strukturu TList.
@@ -167,6 +636,26 @@ void inicializeList(TList *list)
 }
 
 
+/**
+ * Inicializuje strukturu TConfig
+ * @param config Ukazatel na strukturu TConfig
+ */
+void inicializeConfig(TConfig *config)
+{
+  config->binaryInput = false;
+  config->binaryOutput = false;
+  config->cpuFeatures = false;
+  config->batch = false;
+  config->inputNumberBase = 0;
+  config->outputNumberBasesCount = 0;
+  config->digitsStart = 0;
+  config->digitsLength = 0;
+  config->leadingDigits = 0;
+  config->verify = false;
+  config->shardsCount = 0;
+}
+
+
 /**
  * Inicializuje strukturu TNum
  * @param num Ukazatel na strukturu TNum
@@ -175,7 +664,15 @@ void inicializeNum(TNum *num)
 {
   num->inputNumberBase = 0;
   num->outputNumberBase = 0;
+  num->outputNumberBasesCount = 0;
   inicializeList(&num->list);
+  num->storeList = true;
+  for (uint8_t i = 0; i < MAX_OUTPUT_BASES; i++)
+    inicializeList(&num->outputLists[i]);
+  num->digitsLimit = 0;
+  num->verify = false;
+  for (uint8_t i = 0; i < VERIFY_PRIMES; i++)
+    num->residues[i] = 0;
 }
 
 
@@ -187,9 +684,16 @@ void inicializeNum(TNum *num)
  */
 TListBlock *addNewListBlock(TList *list, bool last)
 {
-  TListBlock *listBlock = malloc(sizeof(TListBlock));
-  if (listBlock == NULL)  /* chyba pri alokaci */
-    return NULL;
+  TListBlock *listBlock = spareListBlocks;
+
+  if (listBlock != NULL) {  /* pouziti uvolneneho bloku */
+    spareListBlocks = listBlock->next;
+  }
+  else {
+    listBlock = malloc(sizeof(TListBlock));
+    if (listBlock == NULL)  /* chyba pri alokaci */
+      return NULL;
+  }
 
   for (uint16_t i = 0; i < NUM_BLOCK_SIZE; i++)  /* inicializace cisel */
     listBlock->num[i] = 0;
@@ -238,224 +742,102 @@ void destroyListBlock(TListBlock *listBlock, TList *list)
   if (listBlock == list->last)
     list->last = listBlock->prev;
 
-  free(listBlock);
+  /* blok se uschova pro dalsi pouziti */
+  listBlock->next = spareListBlocks;
+  spareListBlocks = listBlock;
 }
 
 
 /**
- * Zrusi seznam a uvolni veskerou pamet.
+ * Zrusi seznam, jeho bloky se uschovaji pro dalsi pouziti.
  * @param list Ukazatel na strukturu TList.
  */
 void destroyList(TList *list)
 {
-  /*
-     Zde je vyuzito ukazatele list->last na strukturu TListBlock
-     jako pomocneho ukazatele z duvodu nepotrebnosti.
-     Je mozne si vytvorit novy pomocny ukazatel, coz by bylo reseni
-     prehlednejsi, ovsem ne uspornejsi.
-  */
-
-  while (list->first != NULL) {
-    list->last = list->first;
-    list->first = list->first->next;
-    free(list->last);
+  if (list->first != NULL) {
+    /* pripojeni celeho seznamu na zacatek zasobniku uvolnenych bloku */
+    list->last->next = spareListBlocks;
+    spareListBlocks = list->first;
   }
 
+  list->first = NULL;
   list->last = NULL;
 }
 
 
 /**
- * Vypocita jestli je jedna ciselna soustava mocninou druhe ciselne soustavy
- * @param baseOne Prvni ciselna soustava.
- * @param baseTwo Druha ciselna soustava.
- * @return n-ta mocnina, jinak false.
+ * Uvolni veskerou pamet zasobniku uvolnenych bloku.
  */
-uint8_t isPowerOfNumberBase(uint8_t baseOne, uint8_t baseTwo)
+void destroySpareListBlocks(void)
 {
-  /* TODO Slo by mozna napsat lepe pomoci prevodni tabulky */
-
-  /** baseOne musi byt mensi nebo stejna nez baseTwo */
-  if (baseOne > baseTwo) {
-    /* prohozeni promennych pomoci operace XOR */
-    baseTwo = baseOne ^ baseTwo;
-    baseOne = baseTwo ^ baseOne;
-    baseTwo = baseOne ^ baseTwo;
-  }
-
-  /** zjisteni urovne mocniny */
-  uint16_t power = baseOne;  /**< uroven mocniny soustavy baseOne */
-  uint8_t nPower = 1;  /**< n-ta mocnina */
-  /* dokud uroven mocniny nepresahne maximalni ciselnou soustavu */
-  while (power <= MAX_NUMBER_BASE) {
-    if (power == baseTwo)  /* uroven mocniny nalezena */
-      return nPower;  /* vracime hodnotu urovne */
+  TListBlock *listBlock;  /**< pomocny ukazatel na uvolnovany blok */
 
-    /* posun na dalsi uroven mocniny */
-    power *= baseOne;
-    nPower++;
+  while (spareListBlocks != NULL) {
+    listBlock = spareListBlocks;
+    spareListBlocks = spareListBlocks->next;
+    free(listBlock);
   }
-
-  return false;
-}
-
-
-/**
- * Overi, jestli je dany znak cislo
- * @param ch Znak.
- * @return true = je cislo, false = neni cislo
- */
-bool isNumber(char ch)
-{
-  if (ch >= '0' && ch <= '9')  /* cislo */
-    return true;
-
-  return false;
 }
 
 
 /**
- * Overi, jesti je dany znak pismeno
- * @param ch Znak.
- * @return true = je cislo, false = neni cislo
+ * Zkrati seznam za zadanym blokem, nasledujici bloky se uschovaji.
+ * @param listBlock Ukazatel na posledni zachovany blok.
+ * @param list Ukazatel na strukturu TList.
  */
-bool isLetter(char ch)
+void truncateList(TListBlock *listBlock, TList *list)
 {
-  if (ch >= 'A' && ch <= 'Z')  /* pismeno */
-    return true;
+  if (listBlock->next != NULL) {
+    list->last->next = spareListBlocks;
+    spareListBlocks = listBlock->next;
+    listBlock->next = NULL;
+  }
 
-  return false;
+  list->last = listBlock;
 }
 
 
 /**
- * Nacte data ze vstupu do struktury TNum
- * @param num Ukazatel na strukuturu typu TNum.
+ * Vytvori kopii seznamu.
+ * @param dest Ukazatel na prazdnou strukturu TList pro kopii.
+ * @param src Ukazatel na kopirovany seznam.
  * @return Kod z vyctu codes.
  */
-uint8_t readInput(TNum *num)
+uint8_t copyList(TList *dest, const TList *src)
 {
-  char buf[NUM_BLOCK_SIZE];  /**< nacitaci buffer */
-  short readBytes;  /**< Pocet nactenych bytu */
-
-  /** Kontrola prvniho vstupniho znaku */
-  readBytes = read(STDIN, buf, 1);
-  if (readBytes == -1)  /* chyba pri cteni ze vstupu */
-    return EREAD;
-  if (readBytes == 0)  /* nic jsme nenacetli */
-    return EINPUT;
-  if (buf[0] != '[')  /* vstpuni data nejsou ve spravnem formatu */
-    return EINPUT;
-
-  TListBlock *listBlock = NULL;  /**< ukazatel na aktualni blok */
+  TListBlock *listBlock;  /**< ukazatel na kopirovany blok */
+  TListBlock *destListBlock;  /**< ukazatel na novy blok */
   uint16_t i;  /**< iterator cyklu for */
 
-  /** Nacitani vstpunich dat */
-  while ((readBytes = read(STDIN, buf, NUM_BLOCK_SIZE)) != 0) {
-    if (readBytes == -1) /* chyba pri cteni ze vstupu */
-      return EREAD;
-
-    listBlock = addNewListBlock(&num->list, FIRST); 
-    if (listBlock == NULL)  /* chyba pri alokaci pameti */
+  for (listBlock = src->first; listBlock != NULL; listBlock = listBlock->next) {
+    destListBlock = addNewListBlock(dest, FIRST);
+    if (destListBlock == NULL) {  /* chyba pri alokaci pameti */
+      destroyList(dest);
       return EMEM;
+    }
 
-    /** Zpracovani vsech nactenych znaku */
-    for (i = 0; i < readBytes; i++) {
+    for (i = 0; i < listBlock->numCount; i++)
+      destListBlock->num[i] = listBlock->num[i];
+    destListBlock->numCount = listBlock->numCount;
+  }
 
-      if (isNumber(buf[i])) {  /* nacitame cislo */
-        listBlock->num[listBlock->numCount++] = (uint8_t) (buf[i] - '0');
-      }
-      else if (isLetter(buf[i])) {  /* nacitame pismeno */
-        listBlock->num[listBlock->numCount++] = (uint8_t) (buf[i] - 'A' + 10);
-      }
-      else if (buf[i] == ']') {  /* konec nacitaneho cisla */
-        /* Nacteni "zadneho cisla" neni povazovano za chybu '[]2=10' */
+  return EOK;
+}
 
-        i++;  /* posunuti za znak ']' */
 
-        /** Donacteni pripadnych nenactenych znaku */
-        uint8_t lastReadBytes = readBytes - i;  /* zbyva znaku (pocet) */
+/**
+ * Odstrani zbytecne pocatecni nuly ze seznamu (nulova hodnota = jedna '0').
+ * @param list Ukazatel na strukturu TList.
+ */
+void removeLeadingZeros(TList *list)
+{
+  TListBlock *listBlock = list->first;  /**< ukazatel na aktualni blok */
+  uint16_t i;  /**< iterator cyklu */
 
-        if (readBytes == NUM_BLOCK_SIZE) {  /* zrejme mame stale co nacitat */
-          /* presun zbytku z konce na zacatek */
-          uint8_t k = 0;
-          while (i < readBytes && k <= 5)  /* max. 5 znaku je relevantnich */
-            buf[k++] = buf[i++];
-          i = 0;  /* nastaveni iteratoru na zacatek */
-
-          /* nacteni zbytku (max. 5 znaku je relevantnich) */
-          readBytes = read(STDIN, (buf + k), 5);
-          lastReadBytes += readBytes;
-          readBytes = 0;  /* priznak pouziti lastReadBytes */
-        }
-
-        /** Overeni poctu poslednich znaku (musi byt vice nez 3) */
-        if (lastReadBytes < 3)
-          return EINPUT;
-
-        /** Zpracovani vstupni ciselne soustavy */
-        if (isNumber(buf[i]))
-          num->inputNumberBase = (uint8_t) (buf[i] - '0');
-        else
-          return EINPUT;
-
-        i++;  /* posun na dalsi znak */
-
-        if (buf[i] != '=') {  /* pokud je soustava dvojciferna */
-          if (isNumber(buf[i])) {
-            num->inputNumberBase = (num->inputNumberBase * 10)
-                                   + (uint8_t) (buf[i] - '0');
-            i++;  /* posun na dalsi znak */
-          }
-          else {
-            return EINPUT;
-          }
-        }
-
-        if (buf[i] != '=') {  /* pokud neexistuje oddelovac soustav */
-          return EINPUT;
-        }
-        i++;  /* posun na dalsi znak */
-
-        /* pokud neni co cist */
-        if ((readBytes != 0 && i >= readBytes) ||
-            (readBytes == 0 && i >= lastReadBytes)) {
-          return EINPUT;
-        }
-
-        /** Zpracovani vystupni ciselne soustavy */
-        if (isNumber(buf[i]))
-          num->outputNumberBase = (uint8_t) (buf[i] - '0');
-        else {
-          return EINPUT;
-        }
-
-        i++;  /* posun na dalsi znak */
-
-         /* pokud existuje posledni znak */
-        if ((readBytes != 0 && i < readBytes) ||
-            (readBytes == 0 && i < lastReadBytes)) {
-          if (isNumber(buf[i])) {
-            num->outputNumberBase = (num->outputNumberBase * 10)
-                                    + (uint8_t) (buf[i] - '0');
-          }
-        }
-
-        clearBuffer();
-        break;
-      }
-      else {  /* neakceptovatelny znak */
-        return EINPUT;
-      }
-    }
-  }
-
-  /** Odstraneni zbytecnych pocatecnich nul */
-  listBlock = num->list.first;
   while (listBlock != NULL) {
     i = 0;
     /* dokud jsou v bloku nejake zbytecne nuly */
-    while (listBlock->num[i] == 0 && listBlock->numCount != 0) {
+    while (listBlock->numCount != 0 && listBlock->num[i] == 0) {
       listBlock->numCount--;
       i++;
     }
@@ -472,7 +854,7 @@ uint8_t readInput(TNum *num)
       else {
         /* pokracujeme nasledujicim blokem a predchozi zrusime */
         listBlock = listBlock->next;
-        destroyListBlock(listBlock->prev, &num->list);
+        destroyListBlock(listBlock->prev, list);
       }
     }
     /* block neni prazdny */
@@ -485,434 +867,2160 @@ uint8_t readInput(TNum *num)
       break;
     }
   }
+}
+
+
+/**
+ * Pripravi seznam pro prevod Hornerovym schematem (hornerStep).
+ * Seznam bude obsahovat hodnotu 0.
+ * @param list Ukazatel na prazdnou strukturu TList.
+ * @return Kod z vyctu codes.
+ */
+uint8_t inicializeHorner(TList *list)
+{
+  TListBlock *listBlock = addNewListBlock(list, LAST);
+  if (listBlock == NULL)  /* chyba pri alokaci pameti */
+    return EMEM;
+  listBlock->numCount++;  /* kvuli nacteni prvniho cisla */
+
+  return EOK;
+}
+
+
+/**
+ * Jeden krok Hornerova schematu: list = list * inputBase + digit.
+ * Cislo v seznamu je v soustave outputBase a cislice jsou v blocich
+ * zarovnany na konec (nejnizsi rad je num[NUM_BLOCK_SIZE - 1] posledniho
+ * bloku).
+ * @param list Ukazatel na seznam pripraveny funkci inicializeHorner.
+ * @param inputBase Vstupni soustava.
+ * @param outputBase Vystupni soustava.
+ * @param digit Pridavana cislice ve vstupni soustave.
+ * @param limit Pocet nejnizsich cislic, ktere se pocitaji (0 = vsechny).
+ *              Vyssi rady se zahazuji (vysledek modulo outputBase^limit).
+ * @return Kod z vyctu codes.
+ */
+uint8_t hornerStep(TList *list, uint8_t inputBase, uint8_t outputBase,
+                   uint8_t digit, uint64_t limit)
+{
+  TListBlock *listBlock;  /**< ukazatel na aktualni blok */
+  uint32_t carry = digit;  /**< prenos do vyssiho radu */
+  uint64_t position = 0;  /**< pocet zpracovanych cislic */
+
+  /* (all) list * inputBase + digit, od nejnizsiho radu */
+  for (listBlock = list->last; listBlock != NULL;
+       listBlock = listBlock->prev) {
+    carry = multiplyDigits(listBlock->num + NUM_BLOCK_SIZE
+                           - listBlock->numCount, listBlock->numCount,
+                           inputBase, outputBase, carry);
+    position += listBlock->numCount;
+  }
+
+  /* prenos do novych vyssich radu (vyssi rady nez limit se zahazuji) */
+  listBlock = list->first;
+  while (carry != 0 && position != limit) {
+    if (listBlock->numCount == NUM_BLOCK_SIZE) {  /* blok je plny */
+      listBlock = addNewListBlock(list, LAST);
+      if (listBlock == NULL)  /* chyba pri alokaci pameti */
+        return EMEM;
+    }
+
+    listBlock->num[NUM_BLOCK_SIZE - 1 - listBlock->numCount++] =
+      (uint8_t) (carry % outputBase);
+    carry /= outputBase;
+    position++;
+  }
+
+  return EOK;
+}
+
+
+/**
+ * Dokonci prevod Hornerovym schematem - posune cislice neuplneho prvniho
+ * bloku na jeho zacatek, jak ocekavaji ostatni funkce.
+ * @param list Ukazatel na seznam s prevedenym cislem.
+ */
+void finishHorner(TList *list)
+{
+  TListBlock *listBlock = list->first;  /**< prvni blok seznamu */
+  uint16_t i = 0;  /**< iterator cyklu */
+  uint16_t j;  /**< pozice prvni cislice v bloku */
+
+  /** Posun neuplneho seznamu */
+  if (listBlock->numCount != NUM_BLOCK_SIZE) {  /* seznam je neuplny */
+    j = NUM_BLOCK_SIZE - listBlock->numCount;
+    while (i < listBlock->numCount)
+      listBlock->num[i++] = listBlock->num[j++];
+  }
+}
+
+
+/**
+ * Vypocita jestli je jedna ciselna soustava mocninou druhe ciselne soustavy
+ * @param baseOne Prvni ciselna soustava.
+ * @param baseTwo Druha ciselna soustava.
+ * @return n-ta mocnina, jinak false.
+ */
+uint8_t isPowerOfNumberBase(uint8_t baseOne, uint8_t baseTwo)
+{
+  /* TODO Slo by mozna napsat lepe pomoci prevodni tabulky */
+
+  /** baseOne musi byt mensi nebo stejna nez baseTwo */
+  if (baseOne > baseTwo) {
+    /* prohozeni promennych pomoci operace XOR */
+    baseTwo = baseOne ^ baseTwo;
+    baseOne = baseTwo ^ baseOne;
+    baseTwo = baseOne ^ baseTwo;
+  }
+
+  /** zjisteni urovne mocniny */
+  uint16_t power = baseOne;  /**< uroven mocniny soustavy baseOne */
+  uint8_t nPower = 1;  /**< n-ta mocnina */
+  /* dokud uroven mocniny nepresahne maximalni ciselnou soustavu */
+  while (power <= MAX_NUMBER_BASE) {
+    if (power == baseTwo)  /* uroven mocniny nalezena */
+      return nPower;  /* vracime hodnotu urovne */
+
+    /* posun na dalsi uroven mocniny */
+    power *= baseOne;
+    nPower++;
+  }
+
+  return false;
+}
+
+
+/**
+ * Najde nejmensi zaklad, jehoz mocninou je ciselna soustava (napr. 8 -> 2).
+ * Soustavy se stejnym zakladem lze prevadet rychle (pres mocniny).
+ * @param base Ciselna soustava.
+ * @return Zaklad soustavy, pripadne soustava sama.
+ */
+uint8_t rootOfNumberBase(uint8_t base)
+{
+  for (uint8_t root = MIN_NUMBER_BASE; root < base; root++) {
+    if (isPowerOfNumberBase(root, base) != false)
+      return root;
+  }
+
+  return base;
+}
+
+
+/**
+ * Overi, jestli je dany znak cislo
+ * @param ch Znak.
+ * @return true = je cislo, false = neni cislo
+ */
+bool isNumber(char ch)
+{
+  if (ch >= '0' && ch <= '9')  /* cislo */
+    return true;
+
+  return false;
+}
+
+
+/**
+ * Overi, jesti je dany znak pismeno
+ * @param ch Znak.
+ * @return true = je cislo, false = neni cislo
+ */
+bool isLetter(char ch)
+{
+  if (ch >= 'A' && ch <= 'Z')  /* pismeno */
+    return true;
+
+  return false;
+}
+
+
+/**
+ * Nacte ciselnou soustavu (jedno nebo dvouciferne cislo) z bufferu.
+ * @param buf Buffer se zapisem soustav.
+ * @param length Pocet znaku v bufferu.
+ * @param i Ukazatel na pozici v bufferu, posune se za nactenou soustavu.
+ * @return Nactena soustava nebo 0 pri chybe.
+ */
+uint8_t readNumberBase(const char *buf, uint16_t length, uint16_t *i)
+{
+  uint8_t base;  /**< nactena soustava */
+
+  if (*i >= length || !isNumber(buf[*i]))
+    return 0;
+  base = (uint8_t) (buf[(*i)++] - '0');
+
+  if (*i < length && isNumber(buf[*i]))  /* dvouciferna soustava */
+    base = (base * 10) + (uint8_t) (buf[(*i)++] - '0');
+
+  return base;
+}
+
+
+/**
+ * Nacte nezaporne desitkove cislo (nejvyse MAX_DECIMAL_DIGITS cislic).
+ * @param str Retezec s cislem.
+ * @param value Ukazatel na nactenou hodnotu.
+ * @return Ukazatel za cislo nebo NULL, pokud cislo chybi nebo je prilis dlouhe.
+ */
+const char *readDecimal(const char *str, uint64_t *value)
+{
+  uint8_t length = 0;  /**< pocet nactenych cislic */
+
+  *value = 0;
+  while (isNumber(*str)) {
+    if (++length > MAX_DECIMAL_DIGITS)
+      return NULL;
+    *value = (*value * 10) + (uint64_t) (*str++ - '0');
+  }
+
+  return (length == 0) ? NULL : str;
+}
+
+
+/**
+ * Nacte seznam ciselnych soustav oddelenych carkou (Z2,Z3,...).
+ * @param buf Buffer se zapisem soustav.
+ * @param length Pocet znaku v bufferu.
+ * @param i Ukazatel na pozici v bufferu, posune se za nacteny seznam.
+ * @param bases Pole pro nactene soustavy (MAX_OUTPUT_BASES prvku).
+ * @param count Ukazatel na pocet nactenych soustav.
+ * @return true = seznam je v poradku, false = chybny format.
+ */
+bool readNumberBasesList(const char *buf, uint16_t length, uint16_t *i,
+                         uint8_t *bases, uint8_t *count)
+{
+  *count = 0;
+  while (*count < MAX_OUTPUT_BASES) {
+    uint16_t start = *i;  /**< pozice zacatku soustavy */
+    uint8_t base = readNumberBase(buf, length, i);
+    if (*i == start)  /* soustava chybi */
+      return false;
+
+    bases[(*count)++] = base;
+
+    if (*i >= length || buf[*i] != ',')  /* konec seznamu */
+      return true;
+    (*i)++;  /* preskoceni oddelovace ',' */
+  }
+
+  return false;  /* prilis mnoho soustav */
+}
+
+
+/**
+ * Nacte vstupni a vystupni soustavy ve formatu Z1=Z2,Z3,...
+ * @param num Ukazatel na strukuturu typu TNum.
+ * @param buf Buffer se zapisem soustav.
+ * @param length Pocet znaku v bufferu.
+ * @param i Ukazatel na pozici v bufferu, posune se za posledni soustavu.
+ * @return Kod z vyctu codes.
+ */
+uint8_t readNumberBases(TNum *num, const char *buf, uint16_t length,
+                        uint16_t *i)
+{
+  uint16_t start = *i;  /**< pozice zacatku zapisu */
+
+  /** Zpracovani vstupni ciselne soustavy */
+  num->inputNumberBase = readNumberBase(buf, length, i);
+  if (*i == start)  /* soustava chybi */
+    return EINPUT;
+
+  if (*i >= length || buf[*i] != '=')  /* neexistuje oddelovac soustav */
+    return EINPUT;
+  (*i)++;  /* posun na dalsi znak */
+
+  /** Zpracovani vystupnich ciselnych soustav oddelenych ',' */
+  if (!readNumberBasesList(buf, length, i, num->outputNumberBases,
+                           &num->outputNumberBasesCount)) {
+    return EINPUT;
+  }
+
+  num->outputNumberBase = num->outputNumberBases[0];
+
+  return EOK;
+}
+
+
+/**
+ * Zkontroluje rozsah vstupni a vystupnich ciselnych soustav.
+ * @param num Ukazatel na strukuturu typu TNum.
+ * @return Kod z vyctu codes.
+ */
+uint8_t checkNumberBases(const TNum *num)
+{
+  if (num->inputNumberBase < MIN_NUMBER_BASE ||
+      num->inputNumberBase > MAX_NUMBER_BASE) {
+    return EINPUTBASE;
+  }
+
+  if (num->outputNumberBasesCount == 0)
+    return EOUTPUTBASE;
+  for (uint8_t i = 0; i < num->outputNumberBasesCount; i++) {
+    if (num->outputNumberBases[i] < MIN_NUMBER_BASE ||
+        num->outputNumberBases[i] > MAX_NUMBER_BASE) {
+      return EOUTPUTBASE;
+    }
+  }
+
+  return EOK;
+}
+
+
+/**
+ * Nacte soustavy zapsane pred cislem ve formatu Z1=Z2,Z3,...:[
+ * Prvni znak uz byl nacten, znak '[' se nacte take.
+ * @param num Ukazatel na strukuturu typu TNum.
+ * @param first Prvni znak zapisu soustav.
+ * @return Kod z vyctu codes.
+ */
+uint8_t readHeader(TNum *num, char first)
+{
+  char basesBuf[MAX_BASES_LENGTH];  /**< buffer pro zapis soustav */
+  uint16_t basesLength = 0;  /**< pocet znaku v bufferu soustav */
+  uint16_t i = 0;  /**< pozice v bufferu soustav */
+  int ch = (unsigned char) first;  /**< nacteny znak */
+
+  /** Nacteni zapisu soustav az po ':' (po znacich, je kratky) */
+  while (ch != ':') {
+    if (basesLength == MAX_BASES_LENGTH)  /* prilis dlouhy zapis */
+      return EINPUT;
+    basesBuf[basesLength++] = (char) ch;
+
+    ch = readChar();
+    if (ch == INPUT_ERROR)  /* chyba pri cteni ze vstupu */
+      return EREAD;
+    if (ch == INPUT_EOF)  /* chybi ':' */
+      return EINPUT;
+    if (ch == '\n') {  /* konec vyrazu (radku) bez ':' */
+      unreadChar();
+      return EINPUT;
+    }
+  }
+
+  /** Za ':' musi nasledovat cislo v '[' */
+  ch = readChar();
+  if (ch == INPUT_ERROR)  /* chyba pri cteni ze vstupu */
+    return EREAD;
+  if (ch != '[') {
+    if (ch == '\n')  /* konec radku nechame pro dalsi vyraz */
+      unreadChar();
+    return EINPUT;
+  }
+
+  uint8_t state = readNumberBases(num, basesBuf, basesLength, &i);
+  if (state != EOK)
+    return state;
+  if (i != basesLength)  /* pred ':' jsou dalsi znaky */
+    return EINPUT;
+
+  return checkNumberBases(num);
+}
+
+
+/**
+ * Zpracuje parametry prikazove radky.
+ *   --binary-input   vstup v binarnim formatu (vyzaduje --to)
+ *   --binary-output  vystup v binarnim formatu
+ *   --from=Z1        vstupni soustava (vstup je jen [XXX], vyzaduje --to)
+ *   --to=Z2,Z3,...   vystupni soustavy (nahrazuji soustavy ze vstupu)
+ *   --cpu-features   vypise podporovane instrukcni sady a skonci
+ *   --leading=K      vypise jen pocet cislic a K nejvyssich cislic
+ *   --verify         zkontroluje vysledek pomoci zbytku po deleni prvocisly
+ *   --shard-fds=3,4  cislo se cte po castech z otevrenych deskriptoru
+ *                    (nejvyssi rady prvni, vyzaduje --from a --to)
+ * @param argc Pocet parametru.
+ * @param argv Pole parametru.
+ * @param config Ukazatel na strukturu TConfig.
+ * @return Kod z vyctu codes.
+ */
+uint8_t readArguments(int argc, char *argv[], TConfig *config)
+{
+  const char *value;  /**< hodnota parametru za '=' */
+
+  for (int arg = 1; arg < argc; arg++) {
+    if ((value = skipPrefix(argv[arg], "--binary-input")) != NULL &&
+        *value == '\0') {
+      config->binaryInput = true;
+    }
+    else if ((value = skipPrefix(argv[arg], "--binary-output")) != NULL &&
+             *value == '\0') {
+      config->binaryOutput = true;
+    }
+    else if ((value = skipPrefix(argv[arg], "--cpu-features")) != NULL &&
+             *value == '\0') {
+      config->cpuFeatures = true;
+    }
+    else if ((value = skipPrefix(argv[arg], "--batch")) != NULL &&
+             *value == '\0') {
+      config->batch = true;
+    }
+    else if ((value = skipPrefix(argv[arg], "--verify")) != NULL &&
+             *value == '\0') {
+      config->verify = true;
+    }
+    else if ((value = skipPrefix(argv[arg], "--digits=")) != NULL) {
+      value = readDecimal(value, &config->digitsStart);
+      if (value == NULL || *value != ':')
+        return EPARAM;
+      value = readDecimal(value + 1, &config->digitsLength);
+      if (value == NULL || *value != '\0' || config->digitsLength == 0)
+        return EPARAM;
+    }
+    else if ((value = skipPrefix(argv[arg], "--leading=")) != NULL) {
+      uint64_t count;  /**< pocet nejvyssich cislic */
+
+      value = readDecimal(value, &count);
+      if (value == NULL || *value != '\0' || count == 0 ||
+          count > MAX_LEADING_DIGITS) {
+        return EPARAM;
+      }
+      config->leadingDigits = (uint16_t) count;
+    }
+    else if ((value = skipPrefix(argv[arg], "--shard-fds=")) != NULL) {
+      uint64_t fd;  /**< cislo deskriptoru */
+
+      config->shardsCount = 0;
+      do {
+        if (config->shardsCount == MAX_SHARDS)
+          return EPARAM;
+        value = readDecimal(value + (config->shardsCount != 0), &fd);
+        if (value == NULL || fd > INT32_MAX)
+          return EPARAM;
+        config->shardFds[config->shardsCount++] = (int) fd;
+      } while (*value == ',');
+      if (*value != '\0')
+        return EPARAM;
+    }
+    else if ((value = skipPrefix(argv[arg], "--from=")) != NULL) {
+      uint16_t length = stringLength(value);  /**< delka hodnoty */
+      uint16_t i = 0;  /**< pozice v hodnote */
+
+      config->inputNumberBase = readNumberBase(value, length, &i);
+      if (i == 0 || i != length)
+        return EPARAM;
+      if (config->inputNumberBase < MIN_NUMBER_BASE ||
+          config->inputNumberBase > MAX_NUMBER_BASE) {
+        return EINPUTBASE;
+      }
+    }
+    else if ((value = skipPrefix(argv[arg], "--to=")) != NULL) {
+      uint16_t length = stringLength(value);  /**< delka hodnoty */
+      uint16_t i = 0;  /**< pozice v hodnote */
+
+      if (!readNumberBasesList(value, length, &i, config->outputNumberBases,
+                               &config->outputNumberBasesCount) ||
+          i != length) {
+        return EPARAM;
+      }
+
+      for (i = 0; i < config->outputNumberBasesCount; i++) {
+        if (config->outputNumberBases[i] < MIN_NUMBER_BASE ||
+            config->outputNumberBases[i] > MAX_NUMBER_BASE) {
+          return EOUTPUTBASE;
+        }
+      }
+    }
+    else {  /* neznamy parametr */
+      return EPARAM;
+    }
+  }
+
+  /** Binarni vstup neobsahuje vystupni soustavy */
+  if (config->binaryInput && !config->binaryOutput &&
+      config->outputNumberBasesCount == 0) {
+    return EPARAM;
+  }
+
+  /** Binarni vyrazy nejsou oddelene radky */
+  if (config->batch && (config->binaryInput || config->binaryOutput))
+    return EPARAM;
+
+  /** Odhad nejvyssich cislic se nevypisuje binarne ani po usecich */
+  if (config->leadingDigits != 0 &&
+      (config->binaryOutput || config->digitsLength != 0)) {
+    return EPARAM;
+  }
+
+  /** Casti cisla obsahuji jen cislice, soustavy musi byt zadane */
+  if (config->shardsCount != 0 &&
+      (config->inputNumberBase == 0 || config->binaryInput ||
+       config->batch)) {
+    return EPARAM;
+  }
+
+  /** Kontrolovat lze jen cele vypsane cislo */
+  if (config->verify &&
+      (config->leadingDigits != 0 || config->digitsLength != 0)) {
+    return EPARAM;
+  }
+
+  /** Vstup bez soustav za cislem potrebuje i vystupni soustavy */
+  if (config->inputNumberBase != 0 &&
+      (config->binaryInput || config->outputNumberBasesCount == 0)) {
+    return EPARAM;
+  }
+
+  return EOK;
+}
+
+
+/**
+ * Nacte ze vstupu presne zadany pocet bajtu (mene jen na konci vstupu).
+ * @param buf Buffer pro nactena data.
+ * @param size Pocet bajtu k nacteni.
+ * @return Pocet nactenych bajtu nebo -1 pri chybe.
+ */
+int32_t readFully(uint8_t *buf, uint16_t size)
+{
+  uint16_t length = 0;  /**< pocet nactenych bajtu */
+  ssize_t readBytes;  /**< pocet bajtu nactenych jednim volanim read */
+
+  while (length < size) {
+    readBytes = read(STDIN, buf + length, size - length);
+    if (readBytes == -1)  /* chyba pri cteni ze vstupu */
+      return -1;
+    if (readBytes == 0)  /* konec vstupu */
+      break;
+    length += (uint16_t) readBytes;
+  }
+
+  return length;
+}
+
+
+/**
+ * Nacte cislo v binarnim formatu do struktury TNum.
+ * Format: "NSCL", pocet limbu (uint64 LE), limby (uint64 LE, od nejnizsiho).
+ * Cislo se ulozi v sestnactkove soustave, kazdy bajt dava dve cislice.
+ * @param num Ukazatel na strukuturu typu TNum.
+ * @return Kod z vyctu codes.
+ */
+uint8_t readBinaryInput(TNum *num)
+{
+  uint8_t buf[BINARY_BUFFER_SIZE];  /**< nacitaci buffer */
+  int32_t readBytes;  /**< pocet nactenych bajtu */
+  uint64_t limbs = 0;  /**< pocet limbu podle hlavicky */
+  uint64_t readLimbs = 0;  /**< pocet nactenych limbu */
+  uint16_t i;  /**< iterator cyklu for */
+  uint16_t j = 0;  /**< pozice v aktualnim bloku (plni se od konce) */
+
+  /** Kontrola hlavicky */
+  readBytes = readFully(buf, BINARY_HEADER_SIZE);
+  if (readBytes == -1)  /* chyba pri cteni ze vstupu */
+    return EREAD;
+  if (readBytes != BINARY_HEADER_SIZE)
+    return EINPUT;
+  for (i = 0; i < 4; i++) {
+    if (buf[i] != (uint8_t) BINARY_MAGIC[i])
+      return EINPUT;
+  }
+  for (i = BINARY_HEADER_SIZE; i > 4; i--)
+    limbs = (limbs << 8) | buf[i - 1];
+
+  num->inputNumberBase = BINARY_NUMBER_BASE;
+
+  /** Nacitani limbu, cislice se pridavaji od nejnizsiho radu */
+  TListBlock *listBlock = addNewListBlock(&num->list, LAST);
+  if (listBlock == NULL)  /* chyba pri alokaci pameti */
+    return EMEM;
+  j = NUM_BLOCK_SIZE;
+
+  while ((readBytes = readFully(buf, BINARY_BUFFER_SIZE)) != 0) {
+    if (readBytes == -1)  /* chyba pri cteni ze vstupu */
+      return EREAD;
+    if (readBytes % LIMB_SIZE != 0)  /* neuplny limb */
+      return EINPUT;
+
+    readLimbs += readBytes / LIMB_SIZE;
+    if (readLimbs > limbs)  /* vice limbu nez v hlavicce */
+      return EINPUT;
+
+    for (i = 0; i < readBytes; i++) {
+      /* je treba alokovat novy blok? (NUM_BLOCK_SIZE je sude) */
+      if (j == 0) {
+        listBlock->numCount = NUM_BLOCK_SIZE;
+        listBlock = addNewListBlock(&num->list, LAST);
+        if (listBlock == NULL)  /* chyba pri alokaci pameti */
+          return EMEM;
+        j = NUM_BLOCK_SIZE;
+      }
+
+      listBlock->num[--j] = buf[i] & 0x0F;  /* nizsi pulbajt */
+      listBlock->num[--j] = buf[i] >> 4;    /* vyssi pulbajt */
+    }
+  }
+
+  if (readLimbs != limbs)  /* mene limbu nez v hlavicce */
+    return EINPUT;
+
+  /** Posun neuplneho prvniho bloku na zacatek */
+  listBlock->numCount = NUM_BLOCK_SIZE - j;
+  for (i = 0; i < listBlock->numCount; i++)
+    listBlock->num[i] = listBlock->num[j++];
+
+  if (listBlock->numCount == 0) {  /* zadny limb = nula */
+    listBlock->num[0] = 0;
+    listBlock->numCount = 1;
+  }
+
+  removeLeadingZeros(&num->list);
+
+  if (num->verify)  /* zbytky vstupniho cisla (--verify) */
+    residueList(num->residues, &num->list, BINARY_NUMBER_BASE);
+
+  return EOK;
+}
+
+
+/**
+ * Nastavi vystupni soustavy podle prikazove radky (pokud jsou zadany).
+ * @param num Ukazatel na strukturu TNum.
+ * @param config Ukazatel na nastaveni z prikazove radky.
+ */
+void setOutputNumberBases(TNum *num, const TConfig *config)
+{
+  /** Vystupni soustavy z prikazove radky maji prednost */
+  if (config->outputNumberBasesCount != 0) {
+    num->outputNumberBasesCount = config->outputNumberBasesCount;
+    for (uint8_t i = 0; i < config->outputNumberBasesCount; i++)
+      num->outputNumberBases[i] = config->outputNumberBases[i];
+  }
+
+  /** Binarni vystup je vzdy jen jeden (pres sestnactkovou soustavu) */
+  if (config->binaryOutput) {
+    num->outputNumberBases[0] = BINARY_NUMBER_BASE;
+    num->outputNumberBasesCount = 1;
+  }
+}
+
+
+/**
+ * Najde vystupni soustavu, ze ktere se i-ta vystupni soustava odvodi.
+ * Soustavy se stejnym zakladem (napr. 2, 8 a 32) se lisi jen seskupenim
+ * cislic, univerzalne se proto prevadi jen do nejvetsi z nich (ma nejmene
+ * cislic) a ostatni se z ni odvodi linearnim prevodem mezi mocninami.
+ * Opakovana soustava se odvozuje ze sveho prvniho vyskytu (jen kopie).
+ * @param num Ukazatel na strukturu TNum se zadanymi soustavami.
+ * @param i Index vystupni soustavy.
+ * @return Index zdrojove soustavy, i pro soustavy prevadene ze vstupu.
+ */
+uint8_t outputSource(const TNum *num, uint8_t i)
+{
+  uint8_t base = num->outputNumberBases[i];  /**< i-ta vystupni soustava */
+  uint8_t root = rootOfNumberBase(base);  /**< zaklad soustavy */
+  uint8_t source = i;  /**< nejvetsi soustava se stejnym zakladem */
+
+  if (root == rootOfNumberBase(num->inputNumberBase)) {  /* jen ze vstupu */
+    for (uint8_t k = 0; k < i; k++) {  /* opakovana soustava se kopiruje */
+      if (num->outputNumberBases[k] == base)
+        return k;
+    }
+    return i;
+  }
+
+  for (uint8_t k = 0; k < num->outputNumberBasesCount; k++) {
+    uint8_t other = num->outputNumberBases[k];  /**< k-ta soustava */
+    if (rootOfNumberBase(other) != root)
+      continue;
+    if (other > num->outputNumberBases[source] ||  /* pri shode prvni */
+        (other == num->outputNumberBases[source] && k < source)) {
+      source = k;
+    }
+  }
+
+  return source;
+}
+
+
+/**
+ * Pripravi prevod jiz behem cteni vstupu (soustavy jsou zname predem).
+ * Do soustav bez mocninneho vztahu se cislo prevadi Hornerovym schematem
+ * s kazdou nactenou cislici, po konci vstupu tak uz neni co pocitat.
+ * Hornerovo schema bezi jen pro zdrojove soustavy (viz outputSource).
+ * Vstupni cislo se uklada jen pro ostatni soustavy.
+ * @param num Ukazatel na strukturu TNum se zadanymi soustavami.
+ * @return Kod z vyctu codes.
+ */
+uint8_t inicializeOnlineConversion(TNum *num)
+{
+  uint8_t state;  /**< navratovy kod funkci */
+
+  num->storeList = false;
+
+  for (uint8_t i = 0; i < num->outputNumberBasesCount; i++) {
+    if (rootOfNumberBase(num->inputNumberBase) ==
+        rootOfNumberBase(num->outputNumberBases[i])) {
+      num->storeList = true;  /* rychly prevod az po nacteni */
+      continue;
+    }
+    if (outputSource(num, i) != i)  /* odvodi se z jine soustavy */
+      continue;
+
+    state = inicializeHorner(&num->outputLists[i]);
+    if (state != EOK)
+      return state;
+  }
+
+  return EOK;
+}
+
+
+/**
+ * Ulozi usek cislic na konec vstupniho seznamu, bloky se plni cele.
+ * @param num Ukazatel na strukturu TNum.
+ * @param digits Hodnoty cislic.
+ * @param count Pocet cislic.
+ * @param listBlock Ukazatel na posledni blok seznamu (muze se zmenit).
+ * @return Kod z vyctu codes.
+ */
+uint8_t storeDigits(TNum *num, const uint8_t *digits, uint16_t count,
+                    TListBlock **listBlock)
+{
+  uint16_t n;  /**< pocet cislic kopirovanych do bloku */
+
+  for (uint16_t k = 0; k < count; k += n) {
+    if ((*listBlock)->numCount == NUM_BLOCK_SIZE) {
+      *listBlock = addNewListBlock(&num->list, FIRST);
+      if (*listBlock == NULL)  /* chyba pri alokaci pameti */
+        return EMEM;
+    }
+
+    n = NUM_BLOCK_SIZE - (*listBlock)->numCount;
+    if (n > count - k)
+      n = count - k;
+    for (uint16_t m = 0; m < n; m++)
+      (*listBlock)->num[(*listBlock)->numCount + m] = digits[k + m];
+    (*listBlock)->numCount += n;
+  }
+
+  return EOK;
+}
+
+
+/**
+ * Zpracuje usek cislic cisla se znamymi soustavami: zkontroluje cislice,
+ * prubezne je prevede do soustav bez mocninneho vztahu a pripadne ulozi.
+ * @param num Ukazatel na strukturu TNum (po inicializeOnlineConversion).
+ * @param digits Hodnoty cislic.
+ * @param count Pocet cislic.
+ * @param listBlock Ukazatel na posledni blok seznamu (muze se zmenit).
+ * @return Kod z vyctu codes.
+ */
+uint8_t processDigits(TNum *num, const uint8_t *digits, uint16_t count,
+                      TListBlock **listBlock)
+{
+  uint8_t state;  /**< navratovy kod funkci */
+
+  /* pokud cislo v dane ciselne soustave neexistuje */
+  if (maxDigit(digits, count) >= num->inputNumberBase)
+    return EINPUTNUMBER;
+
+  if (num->verify)  /* zbytky vstupniho cisla (--verify) */
+    residueDigits(num->residues, digits, count, num->inputNumberBase);
+
+  /* prubezny prevod do soustav bez mocninneho vztahu */
+  for (uint8_t b = 0; b < num->outputNumberBasesCount; b++) {
+    if (num->outputLists[b].first == NULL)
+      continue;
+
+    for (uint16_t k = 0; k < count; k++) {
+      state = hornerStep(&num->outputLists[b], num->inputNumberBase,
+                         num->outputNumberBases[b], digits[k],
+                         num->digitsLimit);
+      if (state != EOK)
+        return state;
+    }
+  }
+
+  if (!num->storeList)  /* cislo neni treba ukladat */
+    return EOK;
+
+  return storeDigits(num, digits, count, listBlock);
+}
+
+
+/**
+ * Nacte data ze vstupu do struktury TNum
+ * Format: [XXX]Z1=Z2,... nebo Z1=Z2,...:[XXX] nebo [XXX] (--from, --to).
+ * Pokud jsou soustavy zname pred cislem, cislice se kontroluji a prevadi
+ * uz behem cteni.
+ * @param num Ukazatel na strukuturu typu TNum.
+ * @param config Ukazatel na nastaveni z prikazove radky.
+ * @return Kod z vyctu codes.
+ */
+uint8_t readInput(TNum *num, const TConfig *config)
+{
+  const char *buf;  /**< nezpracovana data ve vstupnim bufferu */
+  uint8_t digits[INPUT_BUFFER_SIZE];  /**< hodnoty nactenych cislic */
+  int32_t readBytes;  /**< Pocet nezpracovanych znaku */
+  int ch;  /**< nacteny znak */
+
+  /** Kontrola prvniho vstupniho znaku */
+  ch = readChar();
+  if (ch == INPUT_ERROR)  /* chyba pri cteni ze vstupu */
+    return EREAD;
+  if (ch == INPUT_EOF)  /* nic jsme nenacetli */
+    return EINPUT;
+
+  TListBlock *listBlock = NULL;  /**< ukazatel na aktualni blok */
+  uint16_t i;  /**< iterator cyklu for */
+  uint16_t k;  /**< iterator cyklu pro useky cislic */
+  uint16_t count;  /**< pocet cislic v useku */
+  uint16_t max = 0;  /**< nejvetsi nactena cislice */
+  uint8_t state;  /**< navratovy kod funkci */
+  bool basesKnown = false;  /**< soustavy jsou zname pred cislem */
+  bool closed = false;  /**< byl nacten znak ']' */
+
+  /** Soustavy pred cislem */
+  if (isNumber((char) ch)) {
+    state = readHeader(num, (char) ch);
+    if (state != EOK)
+      return state;
+    basesKnown = true;
+  }
+  else if (ch != '[') {  /* vstpuni data nejsou ve spravnem formatu */
+    if (ch == '\n')  /* konec radku nechame pro dalsi vyraz */
+      unreadChar();
+    return EINPUT;
+  }
+
+  /** Soustavy z prikazove radky */
+  if (config->inputNumberBase != 0) {
+    num->inputNumberBase = config->inputNumberBase;
+    basesKnown = true;
+  }
+
+  /* pro odhad nejvyssich cislic (--leading) se cislo jen ulozi */
+  if (basesKnown && config->leadingDigits == 0) {
+    setOutputNumberBases(num, config);
+    state = inicializeOnlineConversion(num);
+    if (state != EOK)
+      return state;
+  }
+
+  if (num->storeList) {
+    listBlock = addNewListBlock(&num->list, FIRST);
+    if (listBlock == NULL)  /* chyba pri alokaci pameti */
+      return EMEM;
+  }
+
+  /** Nacitani vstpunich dat (primo ze vstupniho bufferu) */
+  while (!closed && (readBytes = fillInput()) != 0) {
+    if (readBytes == -1) /* chyba pri cteni ze vstupu */
+      return EREAD;
+    buf = inputBuffer.buf + inputBuffer.start;
+
+    /** Zpracovani vsech nactenych znaku */
+    for (i = 0; i < readBytes; i++) {
+
+      /** Useky cislic se zpracuji najednou */
+      count = countDigitChars(buf + i, readBytes - i);
+      if (count != 0) {  /* nacitame cislice */
+        parseDigits(buf + i, count, digits);
+        i += count - 1;  /* posun na posledni cislici useku */
+
+        /** Soustavy jeste nejsou zname, kontrola az po nacteni soustav */
+        if (!basesKnown) {
+          k = maxDigit(digits, count);
+          max = (k > max) ? k : max;
+          state = storeDigits(num, digits, count, &listBlock);
+        }
+        /** Soustavy jsou zname predem, cislice se zpracuji hned */
+        else {
+          state = processDigits(num, digits, count, &listBlock);
+        }
+        if (state != EOK)
+          return state;
+      }
+      else if (buf[i] == ']') {  /* konec nacitaneho cisla */
+        /* Nacteni "zadneho cisla" neni povazovano za chybu '[]2=10' */
+        closed = true;
+        inputBuffer.start += i + 1;  /* vcetne ']' */
+
+        /** Nacteni soustav za cislem (nejvyse do konce radku) */
+        if (!basesKnown) {
+          char basesBuf[MAX_BASES_LENGTH];  /**< buffer pro zapis soustav */
+          uint16_t basesLength = 0;  /**< pocet znaku v bufferu soustav */
+
+          while (basesLength < MAX_BASES_LENGTH) {
+            ch = readChar();
+            if (ch == INPUT_ERROR)  /* chyba pri cteni ze vstupu */
+              return EREAD;
+            if (ch == INPUT_EOF)  /* konec vstupu */
+              break;
+            if (ch == '\n') {  /* konec vyrazu */
+              unreadChar();
+              break;
+            }
+            basesBuf[basesLength++] = (char) ch;
+          }
+
+          k = 0;
+          state = readNumberBases(num, basesBuf, basesLength, &k);
+          if (state != EOK)
+            return state;
+        }
+
+        if (!config->batch)  /* zbytek vstupu se ignoruje */
+          clearBuffer(false);
+        break;
+      }
+      else {  /* neakceptovatelny znak */
+        if (buf[i] == '\n')  /* konec radku nechame pro dalsi vyraz */
+          inputBuffer.start += i;
+        return EINPUT;
+      }
+    }
+
+    if (!closed)  /* vsechna data bufferu jsou zpracovana */
+      inputBuffer.start = inputBuffer.end;
+  }
+
+  if (basesKnown) {  /* cislice jiz byly zkontrolovany pri cteni */
+    if (!closed)  /* chybi znak ']' */
+      return EINPUT;
+    if (num->storeList)
+      removeLeadingZeros(&num->list);
+    return EOK;
+  }
+
+  /** Odstraneni zbytecnych pocatecnich nul */
+  removeLeadingZeros(&num->list);
+
+  /** Kontrola rozmezi vstupni a vystupni ciselne soustavy */
+  state = checkNumberBases(num);
+  if (state != EOK)
+    return state;
+
+  /** Kontrola vstupnich cisel (nejvetsi cislice se zjistila pri cteni) */
+  if (max >= num->inputNumberBase)
+    return EINPUTNUMBER;
+
+  /** Zbytky vstupniho cisla, soustava nebyla pri cteni znama */
+  if (num->verify)
+    residueList(num->residues, &num->list, num->inputNumberBase);
+
+  return EOK;
+}
+
+
+/**
+ * Nacte cislo rozdelene do vice casti (--shard-fds). Casti se ctou postupne
+ * z jiz otevrenych deskriptoru od nejvyssich radu a obsahuji jen cislice
+ * (na konci muze byt odradkovani). Soustavy jsou zadane parametry --from
+ * a --to, cislice se tak zpracuji stejne jako u vstupu Z1=Z2:[XXX].
+ * @param num Ukazatel na strukturu TNum.
+ * @param config Ukazatel na nastaveni z prikazove radky.
+ * @return Kod z vyctu codes.
+ */
+uint8_t readShards(TNum *num, const TConfig *config)
+{
+  char buf[INPUT_BUFFER_SIZE];  /**< nactena data casti */
+  uint8_t digits[INPUT_BUFFER_SIZE];  /**< hodnoty nactenych cislic */
+  ssize_t readBytes;  /**< pocet nactenych znaku */
+  uint16_t i;  /**< pozice v nactenych datech */
+  uint16_t count;  /**< pocet cislic v useku */
+  uint8_t state;  /**< navratovy kod funkci */
+  TListBlock *listBlock = NULL;  /**< ukazatel na aktualni blok */
+
+  num->inputNumberBase = config->inputNumberBase;
+  setOutputNumberBases(num, config);
+  if (config->leadingDigits == 0) {  /* --leading potrebuje cele cislo */
+    state = inicializeOnlineConversion(num);
+    if (state != EOK)
+      return state;
+  }
+
+  if (num->storeList) {
+    listBlock = addNewListBlock(&num->list, FIRST);
+    if (listBlock == NULL)  /* chyba pri alokaci pameti */
+      return EMEM;
+  }
+
+  for (uint8_t shard = 0; shard < config->shardsCount; shard++) {
+    bool closed = false;  /**< cast uz skoncila odradkovanim */
+
+    while ((readBytes = read(config->shardFds[shard], buf,
+                             INPUT_BUFFER_SIZE)) != 0) {
+      if (readBytes == -1)  /* chyba pri cteni casti */
+        return EREAD;
+
+      for (i = 0; i < readBytes; i += count) {
+        if (closed)  /* za odradkovanim jsou dalsi znaky */
+          return EINPUT;
+
+        count = countDigitChars(buf + i, (uint16_t) (readBytes - i));
+        if (count == 0) {  /* jediny povoleny znak mimo cislice */
+          if (buf[i] != '\n')
+            return EINPUT;
+          closed = true;
+          count = 1;
+          continue;
+        }
+
+        parseDigits(buf + i, count, digits);
+        state = processDigits(num, digits, count, &listBlock);
+        if (state != EOK)
+          return state;
+      }
+    }
+  }
+
+  if (num->storeList)
+    removeLeadingZeros(&num->list);
+
+  return EOK;
+}
+
+
+/**
+ * Vypise obsah struktury TNum na vystup
+ * Cislo se formatuje do vystupniho bufferu, ktery se vypise jednim volanim
+ * write vzdy po zaplneni (useky OUTPUT_BUFFER_SIZE) a po zpracovani vyrazu.
+ * Pri kontrole (--verify) se ze stejnych useku pocitaji zbytky vystupu.
+ * @param num Ukazatel na strukuturu typu TNum.
+ * @return Kod z vyctu codes.
+ */
+uint8_t printNumbers(TNum *num)
+{
+  char *buf = outputBuffer.buf;  /**< vypisovy buffer */
+  size_t j = outputBuffer.length;  /**< pocet znaku v bufferu */
+  uint64_t residues[VERIFY_PRIMES] = {0};  /**< zbytky vystupniho cisla */
+  uint16_t i;  /**< iterator cyklu for */
+  uint16_t count;  /**< pocet cislic prevadenych najednou */
+  uint8_t state = EOK;  /**< navratovy kod funkci */
+  TListBlock *listBlock;  /**< ukazatel na aktualni blok */
+
+  /** Zacatek cisla, konec ']' + soustava + '\n' ma nejvyse 4 znaky */
+  if (OUTPUT_BUFFER_SIZE - j < 5) {
+    outputBuffer.length = j;
+    state = flushOutput();
+    j = 0;
+  }
+  buf[j++] = '[';
+
+  listBlock = num->list.first;
+  while (listBlock != NULL && state == EOK) {
+    for (i = 0; i < listBlock->numCount && state == EOK; i += count) {
+      count = listBlock->numCount - i;
+      if (count > OUTPUT_BUFFER_SIZE - j)
+        count = (uint16_t) (OUTPUT_BUFFER_SIZE - j);
+
+      formatDigits(listBlock->num + i, count, buf + j);
+      j += count;
+      if (num->verify) {
+        residueDigits(residues, listBlock->num + i, count,
+                      num->outputNumberBase);
+      }
+
+      if (j == OUTPUT_BUFFER_SIZE) {  /* usek je plny */
+        outputBuffer.length = j;
+        state = flushOutput();
+        j = 0;
+      }
+    }
+    listBlock = listBlock->next;
+
+    if (listBlock != NULL)  /* zruseni zpracovaneho bloku */
+      destroyListBlock(listBlock->prev, &num->list);
+  }
+
+  destroyList(&num->list);
+  if (state != EOK)  /* chyba pri zapisu */
+    return state;
+
+  /** Konec cisla: ']', soustava a odradkovani */
+  if (OUTPUT_BUFFER_SIZE - j < 4) {
+    outputBuffer.length = j;
+    state = flushOutput();
+    j = 0;
+  }
+  buf[j++] = ']';
+  if (num->outputNumberBase < 10) {  /* jednociferna soustava */
+    buf[j++] = num2char[num->outputNumberBase];
+  }
+  else {  /* dvouciferna soustava */
+    buf[j++] = (char) ((num->outputNumberBase / 10) + '0');
+    buf[j++] = (char) ((num->outputNumberBase % 10) + '0');
+  }
+  buf[j++] = '\n';  /* odradkovani */
+  outputBuffer.length = j;
+
+  /** Vystup musi mit stejne zbytky jako vstup */
+  for (uint8_t k = 0; num->verify && k < VERIFY_PRIMES; k++) {
+    if (state == EOK && residues[k] != num->residues[k])
+      state = EVERIFY;
+  }
+
+  return state;
+}
+
+
+/**
+ * Vlozi text (napr. chybove hlaseni) do vystupniho bufferu.
+ * @param str Retezec ukonceny '\0'.
+ * @return Kod z vyctu codes.
+ */
+uint8_t printString(const char *str)
+{
+  uint8_t state = EOK;  /**< navratovy kod funkci */
+
+  for (; *str != '\0' && state == EOK; str++) {
+    if (outputBuffer.length == OUTPUT_BUFFER_SIZE)
+      state = flushOutput();
+    outputBuffer.buf[outputBuffer.length++] = *str;
+  }
+
+  return state;
+}
+
+
+/**
+ * Vypise cislo v binarnim formatu (viz readBinaryInput) na vystup.
+ * Cislo musi byt v sestnactkove soustave (BINARY_NUMBER_BASE).
+ * @param num Ukazatel na strukuturu typu TNum.
+ * @return Kod z vyctu codes.
+ */
+uint8_t printBinary(TNum *num)
+{
+  uint8_t buf[BINARY_BUFFER_SIZE];  /**< vystupni buffer */
+  uint16_t j = 0;  /**< pocet bajtu v bufferu */
+  uint64_t digits = 0;  /**< pocet cislic cisla */
+  uint64_t bytes;  /**< pocet bajtu vsech limbu */
+  bool high = false;  /**< zapisuje se vyssi pulbajt */
+  TListBlock *listBlock;  /**< ukazatel na aktualni blok */
+  uint64_t residues[VERIFY_PRIMES] = {0};  /**< zbytky vystupniho cisla */
+  uint16_t i;  /**< iterator cyklu */
+
+  for (listBlock = num->list.first; listBlock != NULL;
+       listBlock = listBlock->next) {
+    digits += listBlock->numCount;
+    if (num->verify) {
+      residueDigits(residues, listBlock->num, listBlock->numCount,
+                    BINARY_NUMBER_BASE);
+    }
+  }
+
+  /** Vystup musi mit stejne zbytky jako vstup */
+  for (i = 0; num->verify && i < VERIFY_PRIMES; i++) {
+    if (residues[i] != num->residues[i]) {
+      destroyList(&num->list);
+      return EVERIFY;
+    }
+  }
+  bytes = ((digits + (2 * LIMB_SIZE) - 1) / (2 * LIMB_SIZE)) * LIMB_SIZE;
+
+  /** Hlavicka */
+  for (i = 0; i < 4; i++)
+    buf[j++] = (uint8_t) BINARY_MAGIC[i];
+  for (i = 0; i < 8; i++)
+    buf[j++] = (uint8_t) ((bytes / LIMB_SIZE) >> (8 * i));
+
+  /** Limby od nejnizsiho radu, tj. od konce seznamu */
+  for (listBlock = num->list.last; listBlock != NULL;
+       listBlock = listBlock->prev) {
+    for (i = listBlock->numCount; i > 0; i--) {
+      if (!high) {
+        buf[j] = (uint8_t) listBlock->num[i - 1];
+      }
+      else {
+        buf[j++] |= (uint8_t) (listBlock->num[i - 1] << 4);
+        bytes--;
+
+        if (j == BINARY_BUFFER_SIZE) {  /* buffer je plny */
+          if (writeFully(buf, j) != EOK) {
+            destroyList(&num->list);
+            return EWRITE;
+          }
+          j = 0;
+        }
+      }
+      high = !high;
+    }
+  }
+  if (high) {  /* lichy pocet cislic */
+    j++;
+    bytes--;
+  }
+
+  /** Doplneni posledniho limbu nulami */
+  while (bytes > 0) {
+    if (j == BINARY_BUFFER_SIZE) {  /* buffer je plny */
+      if (writeFully(buf, j) != EOK) {
+        destroyList(&num->list);
+        return EWRITE;
+      }
+      j = 0;
+    }
+    buf[j++] = 0;
+    bytes--;
+  }
+  destroyList(&num->list);
+
+  return writeFully(buf, j);
+}
+
+
+/**
+ * Rozlozi kazdou cislici na 'power' cislic nizsi soustavy podle tabulky.
+ * @param num Pole vstupnich cislic.
+ * @param count Pocet vstupnich cislic.
+ * @param out Pole pro count * power vystupnich cislic.
+ * @param table Rozklad vsech cislic vstupni soustavy.
+ * @param power N-ta mocnina mezi soustavami.
+ */
+void expandDigits(const uint8_t *num, uint16_t count, uint8_t *out,
+                  uint8_t table[][MAX_POWER], uint8_t power)
+{
+  for (uint16_t i = 0; i < count; i++) {
+    for (uint8_t k = 0; k < power; k++)
+      out[k] = table[num[i]][k];
+    out += power;
+  }
+}
+
+
+/**
+ * Prevod pro cisla z nichz je jedna n-tou mocninou druhe
+ * Funkce NEOVERUJE podminku n-te mocniny soustav!
+ * @param num Ukazatel na strukuturu typu TNum.
+ * @param power N-ta mocnina jedne ze soustav.
+ * @return Kod z vyctu codes.
+ */
+uint8_t powerConvert(TNum *num, uint8_t power)
+{
+  TList list;  /**< vystupni seznam pro data */
+  TListBlock *listBlock = NULL;  /**< ukazatel na aktualni blok */
+  TListBlock *outputListBlock = NULL;  /**< ukazatel na vystupni blok */
+  uint16_t i = 0;  /**< iterator cyklu for (pro vstupni seznam) */
+  uint16_t j = 0;  /**< iterator cyklu for (pro vystupni seznam) */
+  uint8_t k;  /**< iterator cyklu for */
+
+  inicializeList(&list);
+  listBlock = num->list.first;
+
+  /** vstupni soutava < vystupni soustava (prevod na miste) */
+  if (num->inputNumberBase < num->outputNumberBase) {
+    /*
+       Kazda vystupni cislice vznikne z alespon jedne vstupni cislice,
+       zapisovat je tedy mozne primo do vstupniho seznamu za ctecim
+       ukazatelem. Zadny dalsi seznam neni potreba.
+    */
+    const uint16_t base = num->inputNumberBase;  /**< vstupni soustava */
+    uint16_t value;  /**< hodnota skladane vystupni cislice */
+
+    /* pocet cislic prvni (mozna neuplne) skupiny */
+    k = 0;
+    for (; listBlock != NULL; listBlock = listBlock->next)
+      k = (k + listBlock->numCount) % power;
+    if (k == 0)
+      k = power;
+
+    listBlock = outputListBlock = num->list.first;
+
+    while (listBlock != NULL) {
+      /* slozeni vystupni cislice ze skupiny vstupnich cislic (Horner) */
+      value = 0;
+      if (listBlock->numCount - i >= k) {  /* cela skupina v jednom bloku */
+        for (; k > 0; k--)
+          value = value * base + listBlock->num[i++];
+      }
+      else {  /* skupina prechazi do dalsiho bloku */
+        for (; k > 0; k--) {
+          if (i == listBlock->numCount) {
+            listBlock = listBlock->next;
+            i = 0;
+          }
+          value = value * base + listBlock->num[i++];
+        }
+      }
+      k = power;
+
+      /* posun na dalsi vstupni blok */
+      if (i == listBlock->numCount) {
+        listBlock = listBlock->next;
+        i = 0;
+      }
+
+      /* posun na dalsi vystupni blok */
+      if (j == NUM_BLOCK_SIZE) {
+        outputListBlock->numCount = j;  /* pocet zapsanych cisel */
+        outputListBlock = outputListBlock->next;
+        j = 0;
+      }
+      outputListBlock->num[j++] = (uint8_t) value;
+    }
+
+    /** Uschovani nepotrebnych bloku na konci seznamu */
+    outputListBlock->numCount = j;  /* pocet zapsanych cisel */
+    truncateList(outputListBlock, &num->list);
+  }
+  /** vstupni soustava > vystupni soustava */
+  else {
+    /* rozklad kazde vstupni cislice na 'power' vystupnich cislic */
+    uint8_t table[MAX_NUMBER_BASE][MAX_POWER];  /**< prevodni tabulka */
+    uint16_t count;  /**< pocet cislic prevadenych najednou */
+    uint16_t value;  /**< rozkladana hodnota */
+
+    for (i = 0; i < num->inputNumberBase; i++) {
+      value = i;
+      for (k = power; k > 0; k--) {
+        table[i][k - 1] = (uint8_t) (value % num->outputNumberBase);
+        value /= num->outputNumberBase;
+      }
+    }
+
+    while (listBlock != NULL) {
+      for (i = 0; i < listBlock->numCount; i += count) {
+        /* je treba alokovat novy blok? (NUM_BLOCK_SIZE je delitelne power) */
+        if (outputListBlock == NULL ||
+            outputListBlock->numCount == NUM_BLOCK_SIZE) {
+          outputListBlock = addNewListBlock(&list, FIRST);
+          if (outputListBlock == NULL) {  /* chyba pri alokaci pameti */
+            destroyList(&list);
+            return EMEM;
+          }
+        }
+
+        /* prevod useku, ktery se vejde do vystupniho bloku */
+        count = (NUM_BLOCK_SIZE - outputListBlock->numCount) / power;
+        if (count > listBlock->numCount - i)
+          count = listBlock->numCount - i;
+        expandDigits(listBlock->num + i, count,
+                     outputListBlock->num + outputListBlock->numCount,
+                     table, power);
+        outputListBlock->numCount += count * power;
+      }
+      listBlock = listBlock->next;
+
+      if (listBlock != NULL)  /* zruseni zpracovaneho bloku */
+        destroyListBlock(listBlock->prev, &num->list);
+    }
+
+    /** Zruseni stareho a navazani vystupniho seznamu */
+    destroyList(&num->list);
+    num->list.first = list.first;
+    num->list.last = list.last;
+
+    /* odstaneni '0' ze zacatku */
+    removeLeadingZeros(&num->list);
+  }
+
+  return EOK;
+}
+
+
+/**
+ * Univerzalni prevod mezi cisel soustavami
+ * @param num Ukazatel na strukturu TNum.
+ * @return Kod z vyctu codes.
+ */
+uint8_t universalConvert(TNum *num)
+{
+  TList list;  /**< vystupni seznam pro data */
+  TListBlock *listBlock = NULL;  /**< ukazatel na aktualni blok */
+  uint16_t i;  /**< iterator cyklu for */
+  uint8_t state;  /**< navratovy kod funkci */
+
+  /** Inicializace */
+  inicializeList(&list);
+  listBlock = num->list.first;
+
+  state = inicializeHorner(&list);
+  if (state != EOK) {  /* chyba pri alokaci pameti */
+    destroyList(&list);
+    return state;
+  }
+
+  /** Prevod */
+  while (listBlock != NULL) {
+    for (i = 0; i < listBlock->numCount; i++) {
+      state = hornerStep(&list, num->inputNumberBase, num->outputNumberBase,
+                         listBlock->num[i], num->digitsLimit);
+      if (state != EOK) {  /* chyba pri alokaci pameti */
+        destroyList(&list);
+        return state;
+      }
+    }
+    listBlock = listBlock->next;
+
+    if (listBlock != NULL)  /* zruseni zpracovaneho bloku */
+      destroyListBlock(listBlock->prev, &num->list);
+  }
+
+  finishHorner(&list);
+
+  /** Zruseni stareho a navazani vystupniho seznamu */
+  destroyList(&num->list);
+  num->list.first = list.first;
+  num->list.last = list.last;
+
+  return EOK;
+}
+
+
+/**
+ * Ponecha v seznamu jen cislice na pozicich start az start + length - 1
+ * (pocitano od nejnizsiho radu). Chybejici vyssi rady se doplni nulami,
+ * vysledek ma tedy vzdy presne length cislic.
+ * @param list Ukazatel na seznam s cislem.
+ * @param start Pozice nejnizsi ponechane cislice.
+ * @param length Pocet ponechanych cislic (alespon 1).
+ * @return Kod z vyctu codes.
+ */
+uint8_t extractDigits(TList *list, uint64_t start, uint64_t length)
+{
+  TList slice;  /**< seznam s vybranymi cislicemi */
+  TListBlock *listBlock = list->last;  /**< aktualni blok (od nejnizsiho) */
+  TListBlock *sliceBlock = NULL;  /**< aktualni blok vyberu */
+  uint16_t i = (listBlock != NULL) ? listBlock->numCount : 0;  /**< pozice */
+  uint8_t digit;  /**< prenasena cislice */
+
+  inicializeList(&slice);
+
+  /** Preskoceni nizsich cislic */
+  for (; start > 0 && listBlock != NULL; start--) {
+    if (i == 0) {
+      listBlock = listBlock->prev;
+      if (listBlock == NULL)
+        break;
+      i = listBlock->numCount;
+    }
+    i--;
+  }
 
-  /** Kontrola vstupnich cisel */
-  listBlock = num->list.first;
-  while (listBlock != NULL) {
-    for (i = 0; i < listBlock->numCount; i++) {
-      /* pokud cislo v dane ciselne soustave neexistuje */
-      if (listBlock->num[i] >= num->inputNumberBase)
-        return EINPUTNUMBER;
+  /** Vyber cislic, bloky se plni od konce jako v Hornerove schematu */
+  for (; length > 0; length--) {
+    while (listBlock != NULL && i == 0) {
+      listBlock = listBlock->prev;
+      if (listBlock != NULL)
+        i = listBlock->numCount;
     }
+    digit = (listBlock != NULL) ? listBlock->num[--i] : 0;
 
-    listBlock = listBlock->next;
+    if (sliceBlock == NULL || sliceBlock->numCount == NUM_BLOCK_SIZE) {
+      sliceBlock = addNewListBlock(&slice, LAST);
+      if (sliceBlock == NULL) {  /* chyba pri alokaci pameti */
+        destroyList(&slice);
+        return EMEM;
+      }
+    }
+    sliceBlock->num[NUM_BLOCK_SIZE - 1 - sliceBlock->numCount++] = digit;
   }
+  finishHorner(&slice);
 
-  /** Kontrola rozmezi vstupni a vystupni ciselne soustavy */
-  if (num->inputNumberBase < MIN_NUMBER_BASE ||
-      num->inputNumberBase > MAX_NUMBER_BASE) {
-    return EINPUTBASE;
-  }
-  if (num->outputNumberBase < MIN_NUMBER_BASE ||
-      num->outputNumberBase > MAX_NUMBER_BASE) {
-    return EOUTPUTBASE;
-  }
+  /** Zruseni puvodniho a navazani vybraneho seznamu */
+  destroyList(list);
+  list->first = slice.first;
+  list->last = slice.last;
 
   return EOK;
 }
 
 
 /**
- * Vypise obsah struktury TNum na vystup
- * @param num Ukazatel na strukuturu typu TNum.
- * @return Kod z vyctu codes.
+ * Vrati dolni celou cast dvojkoveho logaritmu.
+ * @param value Kladne cislo.
+ * @return floor(log2(value)).
  */
-uint8_t printNumbers(TNum *num)
+uint8_t floorLog2(uint8_t value)
 {
-  char buf[NUM_BLOCK_SIZE];  /**< nacitaci buffer */
-  uint16_t i;  /**< iterator cyklu for */
+  uint8_t log = 0;  /**< vysledek */
 
-  write(STDOUT, "[", 1);  /* zacatek cisla */
-
-  TListBlock *listBlock = num->list.first;
-  while (listBlock != NULL) {
-    for (i = 0; i < listBlock->numCount; i++) {
-      buf[i] = num2char[listBlock->num[i]];
-    }
-    write(STDOUT, buf, listBlock->numCount);
-    listBlock = listBlock->next;
-
-    if (listBlock != NULL)  /* zruseni zpracovaneho bloku */
-      destroyListBlock(listBlock->prev, &num->list);
+  while (value > 1) {
+    value /= 2;
+    log++;
   }
 
-  destroyList(&num->list);
+  return log;
+}
 
-  buf[0] = ']';  /* konec cisla */
-  if (num->outputNumberBase < 10) {  /* jednociferna soustava */
-    buf[1] = num2char[num->outputNumberBase];
-    write(STDOUT, buf, 2);
+
+/**
+ * Prevede cele cislo zadane cislicemi mezi soustavami (ctvercovy algoritmus
+ * nad polem, pouziva se jen pro kratke useky cisla).
+ * @param in Cislice vstupniho cisla od nejvyssiho radu.
+ * @param count Pocet vstupnich cislic.
+ * @param inBase Vstupni soustava.
+ * @param outBase Vystupni soustava.
+ * @param out Pole pro vysledek (alespon 6 * count + 1 prvku), od nejvyssiho
+ *            radu bez pocatecnich nul.
+ * @return Pocet cislic vysledku.
+ */
+uint64_t convertDigits(const uint16_t *in, uint64_t count, uint8_t inBase,
+                       uint8_t outBase, uint16_t *out)
+{
+  uint64_t length = 0;  /**< pocet cislic vysledku */
+  uint64_t i, j;  /**< iteratory cyklu */
+  uint32_t carry;  /**< prenos do vyssiho radu */
+  uint16_t digit;  /**< odkladana cislice */
+
+  /** Hornerovo schema, vysledek se sklada od nejnizsiho radu */
+  for (i = 0; i < count; i++) {
+    carry = in[i];
+    for (j = 0; j < length; j++) {
+      carry += (uint32_t) out[j] * inBase;
+      out[j] = (uint16_t) (carry % outBase);
+      carry /= outBase;
+    }
+    for (; carry > 0; carry /= outBase)
+      out[length++] = (uint16_t) (carry % outBase);
   }
-  else {  /* dvouciferna soustava */
-    buf[1] = (char) ((num->outputNumberBase / 10) + '0');
-    buf[2] = (char) ((num->outputNumberBase
-                      - ((int) (buf[1] - '0') * 10)) + '0');
-    write(STDOUT, buf, 3);
+  if (length == 0)  /* nula */
+    out[length++] = 0;
+
+  /** Otoceni poradi cislic */
+  for (i = 0, j = length - 1; i < j; i++, j--) {
+    digit = out[i];
+    out[i] = out[j];
+    out[j] = digit;
   }
-  write(STDOUT, "\n", 1);  /* odradkovani */
 
-  return EOK;
+  return length;
 }
 
 
 /**
- * Prevod pro cisla z nichz je jedna n-tou mocninou druhe
- * Funkce NEOVERUJE podminku n-te mocniny soustav!
- * @param num Ukazatel na strukuturu typu TNum.
- * @param power N-ta mocnina jedne ze soustav.
- * @return Kod z vyctu codes.
+ * Zaokrouhli nenulove cele cislo na mantisu o zadane presnosti.
+ * @param digits Cislice cisla od nejvyssiho radu (mohou zacinat nulami).
+ * @param length Pocet cislic.
+ * @param base Soustava cisla.
+ * @param precision Pocet cislic mantisy.
+ * @param up Zaokrouhlit nahoru (jinak se odrizne).
+ * @param f Ukazatel na vysledek.
  */
-uint8_t powerConvert(TNum *num, uint8_t power)
+void roundFloat(const uint16_t *digits, uint64_t length, uint8_t base,
+                uint32_t precision, bool up, TFloat *f)
 {
-  TList list;  /**< vystupni seznam pro data */
-  TListBlock *listBlock = NULL;  /**< ukazatel na aktualni blok */
-  TListBlock *outputListBlock = NULL;  /**< ukazatel na vystupni blok */
-  uint16_t i = 0;  /**< iterator cyklu for (pro vstupni seznam) */
-  uint16_t j = 0;  /**< iterator cyklu for (pro vystupni seznam) */
-  int8_t k;  /**< iterator cyklu for */
-
-  /* mocniny 2 az 6 (co je '0' se nepouziva) */
-  const uint8_t numPower[][6] = {
-    {0, 0, 0, 0, 0, 0},
-    {0, 0, 0, 0, 0, 0},
-    {1, 2, 4, 8, 16, 32},  /* 2 */
-    {1, 3, 9, 27, 0, 0},   /* 3 */
-    {1, 4, 16, 0, 0, 0},   /* 4 */
-    {1, 5, 25, 0, 0, 0},   /* 5 */
-    {1, 6, 36, 0, 0, 0},   /* 6 */
-  };
-
-  inicializeList(&list);
-  listBlock = num->list.first;
-  j = NUM_BLOCK_SIZE;  /* nastaveni potreby alokace noveho bloku */
-  power--;  /* max. uroven mocniny je o 1 mensi */
+  uint64_t i;  /**< iterator cyklu */
 
-  /** vstupni soutava < vystupni soustava */
-  if (num->inputNumberBase < num->outputNumberBase) {
-    /* alokace a inicializace noveho bloku */
-    outputListBlock = addNewListBlock(&list, FIRST);
-    if (outputListBlock == NULL) {  /* chyba pri alokaci pameti */
-      destroyList(&list);
-      return EMEM;
-    }
-    j = 0;
+  while (length > 1 && *digits == 0) {
+    digits++;
+    length--;
+  }
 
-    /* prevod neuplne prvni casti (pokud je treba) */
-    k = num->list.last->numCount % (power + 1);
-    if (k != 0) {
-      /* prevod */
-      while (k > 1) {
-        k--;
-        outputListBlock->num[j] += listBlock->num[i++]
-                                   * numPower[num->inputNumberBase][k];
-      }
-      outputListBlock->num[j++] += listBlock->num[i++];
-    }
+  f->exponent = (int64_t) length - (int64_t) precision;
+  for (i = 0; i < precision; i++)
+    f->num[i] = (i < length) ? digits[i] : 0;
 
-    /* prevod po castech */
-    if (i != listBlock->numCount) {  /* mame co prevadet */
-      while (listBlock != NULL) {
-        /* prevod */
-        for (k = power; k >= 0; k--) {
-          outputListBlock->num[j] += listBlock->num[i]
-                                    * numPower[num->inputNumberBase][k];
-          i++;
+  /** Zaokrouhleni nahoru jen pri nenulovem zbytku */
+  if (!up)
+    return;
+  for (i = precision; i < length && digits[i] == 0; i++)
+    ;
+  if (i >= length)
+    return;
 
-          /* posun na dalsi vstupni blok */
-          if (i == listBlock->numCount) {
-            listBlock = listBlock->next;
-            i = 0;
+  for (i = precision; i > 0; i--) {
+    if (++f->num[i - 1] < base)
+      return;
+    f->num[i - 1] = 0;
+  }
+  f->num[0] = 1;  /* mantisa pretekla na base^precision */
+  f->exponent++;
+}
 
-            if (listBlock != NULL)  /* zruseni zpracovaneho bloku */
-              destroyListBlock(listBlock->prev, &num->list);
-            else
-              break;
-          }
-        }
-        j++;
-        //outputListBlock->num[j++] += listBlock->num[i++];
 
-        /* je treba alokovat novy blok? */
-        if (j == NUM_BLOCK_SIZE) {
-          outputListBlock->numCount = j;  /* pocet nactenych cisel */
-          outputListBlock = addNewListBlock(&list, FIRST);
-          if (outputListBlock == NULL) {  /* chyba pri alokaci pameti */
-            destroyList(&list);
-            return EMEM;
-          }
-          j = 0;
-        }
-      }
-    }
+/**
+ * Vynasobi dve cisla s plovouci radovou carkou a vysledek zaokrouhli.
+ * Vysledek muze byt stejna struktura jako nektery z cinitelu.
+ * @param a Ukazatel na prvni cinitel.
+ * @param b Ukazatel na druhy cinitel.
+ * @param base Soustava mantis.
+ * @param precision Pocet cislic mantis.
+ * @param up Zaokrouhlit nahoru (jinak se odrizne).
+ * @param product Pomocne pole (2 * precision prvku).
+ * @param digits Pomocne pole (2 * precision prvku).
+ * @param result Ukazatel na vysledek.
+ */
+void multiplyFloat(const TFloat *a, const TFloat *b, uint8_t base,
+                   uint32_t precision, bool up, uint64_t *product,
+                   uint16_t *digits, TFloat *result)
+{
+  int64_t exponent = a->exponent + b->exponent;  /**< exponent soucinu */
+  uint32_t length = 2 * precision;  /**< pocet cislic soucinu */
+  uint32_t i, j;  /**< iteratory cyklu */
+
+  for (i = 0; i < length; i++)
+    product[i] = 0;
+  for (i = 0; i < precision; i++) {
+    for (j = 0; j < precision; j++)
+      product[i + j + 1] += (uint64_t) a->num[i] * b->num[j];
+  }
 
-    outputListBlock->numCount = j;  /* pocet nactenych cisel */
+  /** Prenosy do vyssich radu */
+  for (i = length - 1; i > 0; i--) {
+    product[i - 1] += product[i] / base;
+    digits[i] = (uint16_t) (product[i] % base);
   }
-  /** vstupni soustava > vystupni soustava */
-  else {
-    int8_t subtract;  /**< promenna pro ulozeni vysledku po odecteni */
+  digits[0] = (uint16_t) product[0];
 
-    while (listBlock != NULL) {
-      for (i = 0; i < listBlock->numCount; i++) {
-        /* je treba alokovat novy blok? */
-        if (j == NUM_BLOCK_SIZE) {
-          outputListBlock = addNewListBlock(&list, FIRST);
-          if (outputListBlock == NULL) {  /* chyba pri alokaci pameti */
-            destroyList(&list);
-            return EMEM;
-          }
-          j = 0;
-        }
+  roundFloat(digits, length, base, precision, up, result);
+  result->exponent += exponent;
+}
 
-        /* prevod */
-        for (k = power; k >= 1; k--) {
-          subtract = listBlock->num[i];
-          while ((subtract -= numPower[num->outputNumberBase][k]) >= 0) {
-            listBlock->num[i] = subtract;
-            outputListBlock->num[j]++;
-          }
-          j++;
-        }
-        outputListBlock->num[j++] = listBlock->num[i];
-        outputListBlock->numCount = j;  /* pocet nactenych cisel */
-      }
-      listBlock = listBlock->next;
 
-      if (listBlock != NULL)  /* zruseni zpracovaneho bloku */
-        destroyListBlock(listBlock->prev, &num->list);
+/**
+ * Odhadne pocet cislic a nejvyssi cislice cisla z jeho nejvyssich cislic.
+ * Cislo X s n cislicemi lezi v intervalu <H * Z1^m, (H + 1) * Z1^m), kde H
+ * je tvoreno prvnimi n - m cislicemi. Meze se spocitaji v soustave Z2 se
+ * zaokrouhlenim ven, takze odhad je zaruceny. Pokud se meze v pozadovanych
+ * cislicich lisi, odhad selze a je treba vetsi presnost.
+ * @param list Ukazatel na seznam se vstupnim cislem (bez pocatecnich nul).
+ * @param n Pocet cislic cisla.
+ * @param t Pocet pouzitych nejvyssich cislic (mensi nez n).
+ * @param inBase Vstupni soustava Z1.
+ * @param outBase Vystupni soustava Z2.
+ * @param precision Pocet cislic mantis (vetsi nez count).
+ * @param count Pocet pozadovanych nejvyssich cislic.
+ * @param out Pole pro nejvyssi cislice (count prvku).
+ * @param total Ukazatel na pocet cislic cisla v soustave Z2.
+ * @return Kod z vyctu codes, EUNKNOWN pri nerozhodnutelnem odhadu.
+ */
+uint8_t estimateLeading(const TList *list, uint64_t n, uint64_t t,
+                        uint8_t inBase, uint8_t outBase, uint32_t precision,
+                        uint16_t count, uint8_t *out, uint64_t *total)
+{
+  uint64_t m = n - t;  /**< pocet nepouzitych nizsich cislic */
+  uint64_t length;  /**< pocet cislic H v soustave Z2 */
+  uint64_t i;  /**< iterator cyklu */
+  uint16_t *top;  /**< nejvyssi cislice cisla (H) */
+  uint16_t *digits;  /**< H v soustave Z2 */
+  uint16_t *scratch;  /**< pomocne cislice nasobeni */
+  uint64_t *product;  /**< pomocne pole nasobeni */
+  uint16_t base = inBase;  /**< soustava Z1 jako cislo */
+  TFloat low, high;  /**< dolni a horni mez cisla */
+  TFloat lowPower, highPower;  /**< meze mocniny Z1^m */
+  TFloat lowSquare, highSquare;  /**< meze mocnin Z1^(2^k) */
+  const TListBlock *listBlock = list->first;  /**< aktualni blok */
+  uint16_t j = 0;  /**< pozice v bloku */
+  uint8_t state = EOK;  /**< navratovy kod */
+
+  top = malloc((size_t) (7 * t + 2 + 8 * precision) * sizeof(uint16_t));
+  product = malloc((size_t) (2 * precision) * sizeof(uint64_t));
+  if (top == NULL || product == NULL) {  /* chyba pri alokaci pameti */
+    free(top);
+    free(product);
+    return EMEM;
+  }
+  digits = top + t;
+  low.num = digits + 6 * t + 2;
+  high.num = low.num + precision;
+  lowPower.num = high.num + precision;
+  highPower.num = lowPower.num + precision;
+  lowSquare.num = highPower.num + precision;
+  highSquare.num = lowSquare.num + precision;
+  scratch = highSquare.num + precision;
+
+  /** Nejvyssi cislice ze seznamu a jejich prevod (H a H + 1) */
+  for (i = 0; i < t; i++) {
+    while (j == listBlock->numCount) {
+      listBlock = listBlock->next;
+      j = 0;
     }
-
-    /* odstaneni '0' ze zacatku */
-    outputListBlock = list.first;
-    i = 0;
-    /* dokud jsou v bloku nejake zbytecne nuly */
-    while (outputListBlock->num[i] == 0 && outputListBlock->numCount != 0) {
-      outputListBlock->numCount--;
-      i++;
+    top[i] = listBlock->num[j++];
+  }
+  digits[0] = 0;  /* misto pro prenos H + 1 */
+  length = convertDigits(top, t, inBase, outBase, digits + 1) + 1;
+  roundFloat(digits, length, outBase, precision, false, &low);
+  for (i = length; i > 0 && ++digits[i - 1] == outBase; i--)
+    digits[i - 1] = 0;
+  roundFloat(digits, length, outBase, precision, true, &high);
+
+  /** Meze Z1^m binarnim umocnovanim */
+  length = convertDigits(&base, 1, inBase + 1, outBase, digits);
+  roundFloat(digits, length, outBase, precision, false, &lowSquare);
+  roundFloat(digits, length, outBase, precision, false, &highSquare);
+  digits[0] = 1;
+  roundFloat(digits, 1, outBase, precision, false, &lowPower);
+  roundFloat(digits, 1, outBase, precision, false, &highPower);
+
+  for (; m > 0; m /= 2) {
+    if (m % 2 == 1) {
+      multiplyFloat(&lowPower, &lowSquare, outBase, precision, false,
+                    product, scratch, &lowPower);
+      multiplyFloat(&highPower, &highSquare, outBase, precision, true,
+                    product, scratch, &highPower);
     }
-
-    /* pokud je blok prazdny */
-    if (outputListBlock->numCount == 0) {
-      /* nastavime jen jednu '0' */
-      outputListBlock->num[0] = 0;
-      outputListBlock->numCount = 1;
+    if (m > 1) {
+      multiplyFloat(&lowSquare, &lowSquare, outBase, precision, false,
+                    product, scratch, &lowSquare);
+      multiplyFloat(&highSquare, &highSquare, outBase, precision, true,
+                    product, scratch, &highSquare);
     }
-    /* blok neni prazdny */
-    else {
-      if (i != 0) {  /* musime posunovat */
-        j = 0;
-        while (j < outputListBlock->numCount) {
-          outputListBlock->num[j++] = outputListBlock->num[i++];
-        }
-      }
+  }
+
+  multiplyFloat(&low, &lowPower, outBase, precision, false, product,
+                scratch, &low);
+  multiplyFloat(&high, &highPower, outBase, precision, true, product,
+                scratch, &high);
+
+  /** Nejvetsi cislo intervalu je high - 1 */
+  for (i = count; i < precision && high.num[i] == 0; i++)
+    ;
+  if (i == precision) {  /* high - 1 ma v nizsich cislicich same Z2 - 1 */
+    for (i = count; i > 0 && high.num[i - 1] == 0; i--)
+      high.num[i - 1] = outBase - 1;
+    high.num[i - 1]--;
+    if (high.num[0] == 0) {  /* high - 1 ma o cislici mene */
+      for (i = 0; i < count; i++)
+        high.num[i] = outBase - 1;
+      high.exponent--;
     }
   }
 
-  /** Zruseni stareho a navazani vystupniho seznamu */
-  destroyList(&num->list);
-  num->list.first = list.first;
-  num->list.last = list.last;
+  /** Obe meze musi mit stejnou delku i nejvyssi cislice */
+  if (low.exponent < 0 || low.exponent != high.exponent)
+    state = EUNKNOWN;
+  for (i = 0; i < count && state == EOK; i++) {
+    if (low.num[i] != high.num[i])
+      state = EUNKNOWN;
+    out[i] = (uint8_t) low.num[i];
+  }
+  *total = (uint64_t) low.exponent + precision;
 
-  return EOK;
+  free(top);
+  free(product);
+
+  return state;
 }
 
 
 /**
- * Univerzalni prevod mezi cisel soustavami
- * @param num Ukazatel na strukturu TNum.
- * @return Kod z vyctu codes.
+ * Spocita pocet cislic cisla v soustave Z2 a jeho nejvyssi cislice bez
+ * uplneho prevodu. Pouziva se jen tolik nejvyssich cislic vstupu, kolik
+ * vyzaduje presnost; pri nerozhodnutelnem zaokrouhleni se presnost
+ * zdvojnasobi, nejvyse vsak LEADING_ROUNDS krat. Nektera cisla (napr.
+ * mocniny Z2) lezi na hranici cislic pri kazde presnosti, ta je nutne
+ * prevest cela. Soustavy se stejnym zakladem se vzdy prevadi cele, jejich
+ * prevod je linearni a tedy levnejsi nez odhad.
+ * @param list Ukazatel na seznam se vstupnim cislem (bez pocatecnich nul).
+ * @param inBase Vstupni soustava Z1.
+ * @param outBase Vystupni soustava Z2.
+ * @param count Pocet pozadovanych nejvyssich cislic.
+ * @param out Pole pro nejvyssi cislice (count prvku).
+ * @param total Ukazatel na pocet cislic cisla v soustave Z2.
+ * @return Kod z vyctu codes, EUNKNOWN pokud je treba cely prevod.
  */
-uint8_t universalConvert(TNum *num)
+uint8_t leadingDigits(const TList *list, uint8_t inBase, uint8_t outBase,
+                      uint16_t count, uint8_t *out, uint64_t *total)
 {
-  TList list;  /**< vystupni seznam pro data */
-  TListBlock *listBlock = NULL;  /**< ukazatel na aktualni blok */
-  TListBlock *outputListBlock = NULL;  /**< ukazatel na vystupni blok */
-  uint16_t i = 0;  /**< iterator cyklu for */
-  uint16_t j;  /**< iterator cyklu for (pro vystupni seznam) */
-  uint16_t k;  /**< iterator cyklu pro prochazeni bloku */
-  uint16_t borrow = 0;  /**< hodnota na preneseni do dalsiho ciselneho radu */
+  uint64_t n = 0;  /**< pocet cislic vstupniho cisla */
+  uint64_t t;  /**< pocet pouzitych nejvyssich cislic */
+  uint32_t precision = count + LEADING_GUARD_DIGITS;  /**< presnost mantis */
+  uint8_t state = EUNKNOWN;  /**< navratovy kod funkci */
 
-  /** Inicializace */
-  inicializeList(&list);
-  listBlock = num->list.first;
+  if (rootOfNumberBase(inBase) == rootOfNumberBase(outBase))
+    return EUNKNOWN;
 
-  outputListBlock = addNewListBlock(&list, LAST);
-  if (outputListBlock == NULL) {  /* chyba pri alokaci pameti */
-    destroyList(&list);
-    return EMEM;
+  for (const TListBlock *listBlock = list->first; listBlock != NULL;
+       listBlock = listBlock->next) {
+    n += listBlock->numCount;
   }
-  outputListBlock->numCount++;  /* kvuli nacteni prvniho cisla */
 
-  /** Prevod */
-  while (listBlock != NULL) {
-    while (i < listBlock->numCount) {
-      /* (all) list * num->outputNumberBase */
-      outputListBlock = list.last;
-      outputListBlock->num[NUM_BLOCK_SIZE - 1] *= num->inputNumberBase;
-      /* (all) list + listBlock->num[i] */
-      outputListBlock->num[NUM_BLOCK_SIZE - 1] += listBlock->num[i];
-      j = NUM_BLOCK_SIZE - 2;
-      k = 1;
-      while (outputListBlock != NULL) {  /* cely seznam */
-        /* vynasobeni cisla */
-        while (k < outputListBlock->numCount) {  /* vsechny cisla */
-          outputListBlock->num[j--] *= num->inputNumberBase;
-          k++;
-        }
+  /** Odhad z nejvyssich cislic, Z1^(t - 1) >= Z2^(precision + 2) */
+  for (uint8_t round = 0; round < LEADING_ROUNDS && state == EUNKNOWN;
+       round++) {
+    t = (uint64_t) (precision + 2) * (floorLog2(outBase - 1) + 1) /
+        floorLog2(inBase) + 2;
+    if (t >= n)  /* kratke cislo se levneji prevede cele */
+      break;
 
-        /* posun na dalsi blok a inicializace prochazeni seznamu */
-        outputListBlock = outputListBlock->prev;
-        j = NUM_BLOCK_SIZE - 1;
-        k = 0;
-      }
+    state = estimateLeading(list, n, t, inBase, outBase, precision, count,
+                            out, total);
+    precision *= 2;
+  }
 
-      /* prepocet do spravne soustavy */
-      outputListBlock = list.last;
-      while (outputListBlock != NULL) {  /* cely seznam */
-        k = 0;
-        while (k < outputListBlock->numCount) {  /* vsechny cisla */
-          /* navraceni vypujcky */
-          if (borrow != 0) {
-            outputListBlock->num[j] += borrow;
-            borrow = 0;
-          }
+  return state;
+}
 
-          /* vypocet vypujcky */
-          if (outputListBlock->num[j] >= num->outputNumberBase) {
-            /* TODO Nejvetsi zrout vykonu => vymyslet efektivnejsi reseni */
-            borrow = outputListBlock->num[j] / num->outputNumberBase;
-            outputListBlock->num[j] = outputListBlock->num[j]
-                                      % num->outputNumberBase;
-          }
 
-          j--;
-          k++;
-
-          /* je treba pridat dalsi prvek? */
-          if (k == outputListBlock->numCount && borrow != 0) {
-            /* jsme na konci bloku? */
-            if (outputListBlock->numCount == NUM_BLOCK_SIZE) {
-              /* jsme na konci seznamu? */
-              if (outputListBlock->prev == NULL) {
-                /* ano, pridame dalsi blok */
-                outputListBlock = addNewListBlock(&list, LAST);
-                if (outputListBlock == NULL) {  /* chyba pri alokaci pameti */
-                  destroyList(&list);
-                  return EMEM;
-                }
-
-                /* zapocitame vypujcku */
-                outputListBlock->num[NUM_BLOCK_SIZE - 1] = borrow;
-                borrow = 0;
-                outputListBlock->numCount++;
-
-                /* navrat na zpracovavany blok seznamu */
-                outputListBlock = outputListBlock->next;
-              }
 
-              break;
-            }
-            else
-              outputListBlock->numCount++;  /* pridani ciselneho mista */
-          }
-        }
 
-        /* posun na dalsi blok a inicializace prochazeni seznamu */
-        outputListBlock = outputListBlock->prev;
-        j = NUM_BLOCK_SIZE - 1;
-        k = 0;
-      }
+/**
+ * Prevede cislo ve strukture TNum do soustavy num->outputNumberBase
+ * @param num Ukazatel na strukturu TNum.
+ * @return Kod z vyctu codes.
+ */
+uint8_t convertNumber(TNum *num)
+{
+  /* pokud jsou ciselne soustavy stejne, neni treba nic prevadet */
+  if (num->inputNumberBase == num->outputNumberBase)
+    return EOK;
+
+  /* jedna z ciselnych soustav je n-tou mocninou te druhe */
+  uint8_t power;  /**< n-ta mocnina soutavy */
+  power = isPowerOfNumberBase(num->inputNumberBase, num->outputNumberBase);
+  if (power != false)
+    return powerConvert(num, power);
+
+  /* obe soustavy jsou mocninou stejneho zakladu (napr. 8 a 16), prevod ve
+     dvou krocich pres tento zaklad */
+  uint8_t root = rootOfNumberBase(num->inputNumberBase);  /**< zaklad */
+  if (root == rootOfNumberBase(num->outputNumberBase)) {
+    uint8_t outputBase = num->outputNumberBase;  /**< cilova soustava */
+    uint8_t state;  /**< navratovy kod funkci */
+
+    num->outputNumberBase = root;
+    state = powerConvert(num, isPowerOfNumberBase(root,
+                                                  num->inputNumberBase));
+    num->inputNumberBase = root;
+    num->outputNumberBase = outputBase;
+    if (state != EOK)
+      return state;
+
+    return powerConvert(num, isPowerOfNumberBase(root, outputBase));
+  }
 
-      i++;
+  /* univerzalni prevod mezi ciselnymi soustavami */
+  return universalConvert(num);
+}
+
+
+/**
+ * Prevede vstupni cislo (num->list) do zadane soustavy.
+ * @param num Ukazatel na strukturu TNum se vstupnim cislem.
+ * @param base Cilova soustava.
+ * @param lastUse Vstupni seznam se spotrebuje (jinak se kopiruje).
+ * @param result Ukazatel na seznam pro vysledek.
+ * @return Kod z vyctu codes.
+ */
+uint8_t convertInput(TNum *num, uint8_t base, bool lastUse, TList *result)
+{
+  TNum output = *num;  /**< cislo prevadene do soustavy base */
+  uint8_t state;  /**< navratovy kod funkci */
+
+  output.outputNumberBase = base;
+  if (!lastUse) {
+    inicializeList(&output.list);
+    state = copyList(&output.list, &num->list);
+    if (state != EOK) {  /* kopirovani seznamu selhalo */
+      destroyList(&output.list);
+      return state;
     }
-    i = 0;  /* vynulovani iteratoru */
-    listBlock = listBlock->next;
+  }
+  else {
+    inicializeList(&num->list);
+  }
 
-    if (listBlock != NULL)  /* zruseni zpracovaneho bloku */
-      destroyListBlock(listBlock->prev, &num->list);
+  state = convertNumber(&output);
+  if (state != EOK) {  /* prevod cisla selhal */
+    destroyList(&output.list);
+    return state;
   }
+  *result = output.list;
 
-  /** Posun neuplneho seznamu */
-  outputListBlock = list.first;
-  if (outputListBlock->numCount != NUM_BLOCK_SIZE) {  /* seznam je neuplny */
-    j = NUM_BLOCK_SIZE - outputListBlock->numCount;
-    i = 0;
-    while (i < outputListBlock->numCount)
-      outputListBlock->num[i++] = outputListBlock->num[j++];
+  return EOK;
+}
+
+
+/**
+ * Vypise pocet cislic a nejvyssi cislice cisla v soustave Z2 (--leading)
+ * ve tvaru [XXX...]Z2 digits=N. Tecky chybi, pokud se vypsalo cele cislo.
+ * Pokud odhad nerozhodne, cislo se bezne prevede a cislice se vezmou
+ * z vysledku.
+ * @param num Ukazatel na strukturu TNum se vstupnim cislem.
+ * @param outputNumberBase Vystupni soustava Z2.
+ * @param count Pocet pozadovanych nejvyssich cislic.
+ * @param lastUse Vstupni seznam se muze spotrebovat (posledni soustava).
+ * @return Kod z vyctu codes.
+ */
+uint8_t printLeading(TNum *num, uint8_t outputNumberBase, uint16_t count,
+                     bool lastUse)
+{
+  uint8_t digits[MAX_LEADING_DIGITS];  /**< nejvyssi cislice */
+  char buf[MAX_LEADING_DIGITS + 48];  /**< vypisovany text */
+  char decimal[MAX_DECIMAL_DIGITS + 2];  /**< pocet cislic pozpatku */
+  uint16_t outCount = count;  /**< pocet vypsanych cislic */
+  uint64_t total;  /**< pocet cislic cisla */
+  uint16_t j = 0;  /**< delka textu */
+  uint8_t k = 0;  /**< delka poctu cislic */
+  uint8_t state;  /**< navratovy kod funkci */
+
+  state = leadingDigits(&num->list, num->inputNumberBase, outputNumberBase,
+                        count, digits, &total);
+
+  /** Cely prevod, delka a nejvyssi cislice se prectou z vysledku */
+  if (state == EUNKNOWN) {
+    TList list;  /**< prevedene cislo */
+    TListBlock *listBlock;  /**< aktualni blok */
+
+    state = convertInput(num, outputNumberBase, lastUse, &list);
+    if (state != EOK)
+      return state;
+
+    total = 0;
+    outCount = 0;
+    for (listBlock = list.first; listBlock != NULL;
+         listBlock = listBlock->next) {
+      for (uint16_t i = 0; i < listBlock->numCount && outCount < count; i++)
+        digits[outCount++] = listBlock->num[i];
+      total += listBlock->numCount;
+    }
+    destroyList(&list);
   }
+  if (state != EOK)
+    return state;
 
-  /** Zruseni stareho a navazani vystupniho seznamu */
-  destroyList(&num->list);
-  num->list.first = list.first;
-  num->list.last = list.last;
+  buf[j++] = '[';
+  formatDigits(digits, outCount, buf + j);
+  j += outCount;
+  if (total > outCount) {
+    for (uint8_t i = 0; i < 3; i++)
+      buf[j++] = '.';
+  }
+  buf[j++] = ']';
+  if (outputNumberBase >= 10)
+    buf[j++] = (char) ((outputNumberBase / 10) + '0');
+  buf[j++] = num2char[outputNumberBase % 10];
+  for (const char *str = " digits="; *str != '\0'; str++)
+    buf[j++] = *str;
+  do {
+    decimal[k++] = (char) ((total % 10) + '0');
+    total /= 10;
+  } while (total > 0);
+  while (k > 0)
+    buf[j++] = decimal[--k];
+  buf[j++] = '\n';
+  buf[j] = '\0';
+
+  return printString(buf);
+}
 
-  return EOK;
+
+/**
+ * Zrusi vsechny seznamy struktury TNum.
+ * @param num Ukazatel na strukturu TNum.
+ */
+void destroyNum(TNum *num)
+{
+  destroyList(&num->list);
+  for (uint8_t i = 0; i < MAX_OUTPUT_BASES; i++)
+    destroyList(&num->outputLists[i]);
 }
 
 
 /**
  * Prevede cisla z jedne ciselne soustavy do druhe
  * Pouziva standardni vstup a standardni vystup
+ * @param config Ukazatel na nastaveni z prikazove radky.
+ * @return Kod z vyctu codes.
  */
-uint8_t convertNumberBases(void)
+uint8_t convertNumberBases(const TConfig *config)
 {
   uint8_t state;  /**< navratovy kod funkci */
 
   TNum num;  /**< struktura pro zpracovani dat */
   inicializeNum(&num);
 
+  /* z vysledku je treba jen start + length nejnizsich cislic */
+  if (config->digitsLength != 0)
+    num.digitsLimit = config->digitsStart + config->digitsLength;
+  num.verify = config->verify;
+
   /** Nacteni dat ze vstupu */
-  state = readInput(&num);
+  if (config->binaryInput)
+    state = readBinaryInput(&num);
+  else if (config->shardsCount != 0)
+    state = readShards(&num, config);
+  else
+    state = readInput(&num, config);
   if (state != EOK) {  /* nacitani ze vstupu selhalo */    
-    destroyList(&num.list);
+    destroyNum(&num);
+    return state;
+  }
+
+  setOutputNumberBases(&num, config);
+
+  /** Jen pocet cislic a nejvyssi cislice (--leading) */
+  if (config->leadingDigits != 0) {
+    state = EOK;
+    for (uint8_t i = 0; i < num.outputNumberBasesCount && state == EOK; i++) {
+      state = printLeading(&num, num.outputNumberBases[i],
+                           config->leadingDigits,
+                           i + 1 == num.outputNumberBasesCount);
+    }
+    destroyNum(&num);
     return state;
   }
 
-  /** Konverze do vystupni ciselne soustavy */
+  /** Cisla prevedena uz pri cteni se jen dokonci */
+  for (uint8_t i = 0; i < num.outputNumberBasesCount; i++) {
+    if (num.outputLists[i].first != NULL)
+      finishHorner(&num.outputLists[i]);
+  }
+
+  /** Konverze a vypis pro kazdou vystupni soustavu */
+  for (uint8_t i = 0; i < num.outputNumberBasesCount; i++) {
+    TNum output = num;  /**< cislo prevadene do i-te vystupni soustavy */
+    uint8_t source = outputSource(&num, i);  /**< zdrojova soustava */
+    bool lastUse = true;  /**< zadna dalsi soustava seznam nepotrebuje */
+    output.outputNumberBase = num.outputNumberBases[i];
+
+    /** Do zdrojove soustavy se ze vstupu prevadi jen jednou */
+    if (num.outputLists[source].first == NULL) {
+      for (uint8_t k = i + 1; k < num.outputNumberBasesCount; k++) {
+        uint8_t other = outputSource(&num, k);  /**< zdroj k-te soustavy */
+        if (other != source && num.outputLists[other].first == NULL)
+          lastUse = false;
+      }
 
-  /* pokud jsou ciselne soustavy stejne, dojde pouze k vypisu */
-  if (num.inputNumberBase != num.outputNumberBase) {
-    /* jedna z ciselnych soustav je n-tou mocninou te druhe */
-    uint8_t power;  /**< n-ta mocnina soutavy */
-    power = isPowerOfNumberBase(num.inputNumberBase, num.outputNumberBase);
-    if (power != false) {
-      state = powerConvert(&num, power);
+      state = convertInput(&num, num.outputNumberBases[source], lastUse,
+                           &num.outputLists[source]);
       if (state != EOK) {  /* prevod cisla selhal */
-        destroyList(&num.list);
+        destroyNum(&num);
+        return state;
+      }
+    }
+
+    /** Zdrojovy seznam se kopiruje, posledni soustava jej spotrebuje */
+    lastUse = true;
+    for (uint8_t k = i + 1; k < num.outputNumberBasesCount; k++) {
+      if (outputSource(&num, k) == source)
+        lastUse = false;
+    }
+
+    if (!lastUse) {
+      inicializeList(&output.list);
+      state = copyList(&output.list, &num.outputLists[source]);
+      if (state != EOK) {  /* kopirovani seznamu selhalo */
+        destroyList(&output.list);
+        destroyNum(&num);
         return state;
       }
     }
-    /* univerzalni prevod mezi ciselnymi soustavami */
     else {
-      state = universalConvert(&num);
-      if (state != EOK) {  /* prevod cisla selhal */
-        destroyList(&num.list);
+      output.list = num.outputLists[source];
+      inicializeList(&num.outputLists[source]);
+    }
+
+    /** Odvozeni ze zdrojove soustavy (linearni prevod mezi mocninami) */
+    output.inputNumberBase = num.outputNumberBases[source];
+    state = convertNumber(&output);
+    if (state != EOK) {  /* prevod cisla selhal */
+      destroyList(&output.list);
+      destroyNum(&num);
+      return state;
+    }
+
+    /** Vyber pozadovanych cislic (--digits) */
+    if (config->digitsLength != 0) {
+      state = extractDigits(&output.list, config->digitsStart,
+                            config->digitsLength);
+      if (state != EOK) {  /* chyba pri alokaci pameti */
+        destroyList(&output.list);
+        destroyNum(&num);
         return state;
       }
     }
+
+    /** Vypis na standardni vystup */
+    if (config->binaryOutput)
+      state = printBinary(&output);
+    else
+      state = printNumbers(&output);
+    if (state != EOK) {  /* vypis na vystup selhal */
+      destroyList(&output.list);
+      destroyNum(&num);
+      return state;
+    }
   }
 
-  /** Vypis na standardni vystup */
+  return EOK;
+}
 
-  state = printNumbers(&num);
-  if (state != EOK) {  /* vypis na vystup selhal */
-    destroyList(&num.list);
-    return state;
+
+/**
+ * Prevede vsechny vyrazy ze vstupu, jeden vyraz na radek (--batch).
+ * Vysledky se vypisuji v poradi vyrazu. Misto vysledku chybneho vyrazu se
+ * vypise chybove hlaseni a pokracuje se dalsim radkem.
+ * @param config Ukazatel na nastaveni z prikazove radky.
+ * @return Kod prvni chyby (EOK, pokud byly vsechny vyrazy v poradku).
+ */
+uint8_t convertBatch(const TConfig *config)
+{
+  uint8_t result = EOK;  /**< kod prvni chyby */
+  uint8_t state;  /**< navratovy kod funkci */
+  int ch;  /**< nacteny znak */
+
+  while (true) {
+    /* pred blokujicim ctenim se vypisou dosavadni vysledky */
+    if (inputBuffer.start == inputBuffer.end) {
+      state = flushOutput();
+      if (state != EOK)
+        return state;
+    }
+
+    /** Prazdne radky se preskakuji */
+    do {
+      ch = readChar();
+    } while (ch == '\n');
+    if (ch == INPUT_ERROR)  /* chyba pri cteni ze vstupu */
+      return EREAD;
+    if (ch == INPUT_EOF)  /* konec davky */
+      break;
+    unreadChar();
+
+    state = convertNumberBases(config);
+    destroySpareListBlocks();  /* zasobnik by drzel spicku nejvetsiho vyrazu */
+    if (state == EREAD || state == EWRITE || state == EMEM)  /* nelze dal */
+      return state;
+    clearBuffer(true);  /* zbytek radku se ignoruje */
+    if (state != EOK) {  /* chybny vyraz */
+      if (result == EOK)
+        result = state;
+      state = printString(MSG[state]);
+      if (state != EOK)
+        return state;
+    }
   }
 
-  return EOK;
+  return result;
 }
 
 
 /********************************** main() **********************************/
 
-int main(void)
+#ifndef NSC_NO_MAIN  /* bench/bench.c vklada tento soubor bez funkce main */
+
+int main(int argc, char *argv[])
 {
-  uint8_t state = convertNumberBases();
+
+  TConfig config;  /**< nastaveni z prikazove radky */
+  inicializeConfig(&config);
+
+  uint8_t state = readArguments(argc, argv, &config);
+  if (state == EOK && config.cpuFeatures) {  /* jen diagnostika */
+    printCpuFeatures();
+    return EOK;
+  }
+  if (state == EOK && config.batch) {  /* chybne vyrazy jsou ve vystupu */
+    uint8_t result = convertBatch(&config);  /**< kod prvni chyby */
+    state = flushOutput();
+    destroySpareListBlocks();
+    if (result == EOK)
+      result = state;
+    if (result == EREAD || result == EWRITE || result == EMEM)
+      printError(result);
+    return result;
+  }
+  if (state == EOK) {
+    state = convertNumberBases(&config);
+    uint8_t flushState = flushOutput();  /**< vypis zbytku vystupu */
+    if (state == EOK)
+      state = flushState;
+  }
+  destroySpareListBlocks();
   if (state != EOK) {  /* neco je spatne */
-    clearBuffer();  /* TODO Musi tu byt? Overit! */
+    /* pri chybnych parametrech ani pri cteni casti se vstup necte */
+    if (state != EPARAM && config.shardsCount == 0)
+      clearBuffer(false);  /* TODO Musi tu byt? Overit! */
     printError(state);
     return state;
   }
 
   return EOK;
 }
+
+#endif
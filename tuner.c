@@ -0,0 +1,365 @@
+/**
+ * Soubor:    tuner.c
+ * Datum:     2026/10/19
+ * Projekt:   Prevod cisla [www.joineset.com]
+ * Popis:     Prelozi aplikaci nsc pro ruzne velikosti bloku cisel
+ *            (-DNUM_BLOCK_SIZE), zmeri jeji rychlost a na standardni vystup
+ *            vypise hlavickovy soubor tune.h s nejrychlejsi hodnotou.
+ *            Pouziti: ./tuner nsc.c gcc [parametry prekladace] > tune.h
+ *            (nebo make tune)
+ */
+
+/*
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define REPEAT 5  /**< pocet mereni kazde kombinace (bere se median) */
+#define WARMUP 1  /**< pocet zahrivacich behu pred merenim */
+#define TUNE_APP "./nsc-tune"  /**< docasne prelozena aplikace */
+
+
+/**
+ * Kody stavu (predevsim chybovych)
+ */
+enum codes {
+  EOK = 0,      /**< Vse v poradku */
+  EPARAM,       /**< Spatne zadane parametry */
+  EBUILD,       /**< Chyba pri prekladu aplikace nsc */
+  ERUN,         /**< Chyba pri spousteni aplikace nsc */
+  EUNKNOWN,     /**< Neznama chyba */
+};
+
+
+/**
+ * Chybova hlaseni. Jejich poradi odpovida poradi konstant ve vyctu codes.
+ */
+const char *MSG[] = {
+  "OK.",
+  "ERROR! Bad parameters.",
+  "ERROR! Cannot build nsc.",
+  "ERROR! Cannot run nsc.",
+  "ERROR! Unknown error.",
+};
+
+
+/**
+ * Zkousene velikosti bloku cisel (vsechny musi byt delitelne 60). Nejvetsi
+ * odpovida MAX_NUM_BLOCK_SIZE v nsc.c, vetsi hodnotu nsc neprelozi.
+ */
+const unsigned blockSizes[] = {
+  60, 120, 240, 600, 1200, 3000, 6000, 12000, 30000, 60000,
+};
+
+#define BLOCK_SIZES_COUNT (sizeof(blockSizes) / sizeof(blockSizes[0]))
+#define DEFAULT_BLOCK_SIZE_INDEX 3  /**< index vychozi velikosti (600) */
+
+
+/**
+ * Zatez pro mereni - jeden vyraz [XXX]Z1=Z2.
+ */
+typedef struct {
+  unsigned fromBase;  /**< vstupni soustava */
+  unsigned toBase;  /**< vystupni soustava */
+  size_t digits;  /**< pocet cislic */
+  char *input;  /**< vygenerovany vyraz */
+  size_t length;  /**< delka vyrazu */
+} TWorkload;
+
+
+/**
+ * Zatez: univerzalni prevod a oba smery prevodu mezi mocninami soustav.
+ * Kazdy beh trva alespon desetiny sekundy, aby cas spusteni procesu
+ * nepreval nad casem prevodu.
+ */
+TWorkload workloads[] = {
+  {10, 7, 5000, NULL, 0},
+  {2, 16, 40000000, NULL, 0},
+  {16, 2, 12000000, NULL, 0},
+};
+
+#define WORKLOADS_COUNT (sizeof(workloads) / sizeof(workloads[0]))
+
+
+/**
+ * Znakove zastoupeni ciselnych sad
+ */
+const char numbers[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+
+
+/**
+ * Vypise chybove hlaseni na standardni chybovy vystup.
+ * @param error Kod chyby z vyctu codes.
+ */
+void printError(int error)
+{
+  if (error < EOK || error >= EUNKNOWN)
+    error = EUNKNOWN;
+
+  fprintf(stderr, "%s\n", MSG[error]);
+}
+
+
+/**
+ * Vygeneruje nahodny vyraz pro zatez.
+ * @param workload Ukazatel na zatez.
+ * @return 0 pri uspechu, jinak -1.
+ */
+int generateWorkload(TWorkload *workload)
+{
+  workload->input = malloc(workload->digits + 16);
+  if (workload->input == NULL)
+    return -1;
+
+  char *ch = workload->input;
+  *ch++ = '[';
+  *ch++ = numbers[1 + rand() % (workload->fromBase - 1)];
+  for (size_t i = 1; i < workload->digits; i++)
+    *ch++ = numbers[rand() % workload->fromBase];
+  ch += sprintf(ch, "]%u=%u\n", workload->fromBase, workload->toBase);
+  workload->length = (size_t) (ch - workload->input);
+
+  return 0;
+}
+
+
+/**
+ * Prelozi aplikaci nsc s danou velikosti bloku do souboru TUNE_APP.
+ * @param argv Zdrojovy soubor, prekladac a jeho parametry (z main).
+ * @param argc Pocet polozek v argv.
+ * @param blockSize Velikost bloku cisel.
+ * @return 0 pri uspechu, jinak -1.
+ */
+int buildApp(char *argv[], int argc, unsigned blockSize)
+{
+  char define[32];
+  char *args[argc + 4];
+  int status;
+  int n = 0;
+
+  snprintf(define, sizeof(define), "-DNUM_BLOCK_SIZE=%u", blockSize);
+
+  for (int i = 1; i < argc; i++)  /* prekladac a jeho parametry */
+    args[n++] = argv[i];
+  args[n++] = define;
+  args[n++] = "-o";
+  args[n++] = TUNE_APP;
+  args[n++] = argv[0];
+  args[n] = NULL;
+
+  pid_t pid = fork();
+  if (pid == -1)
+    return -1;
+
+  if (pid == 0) {  /* potomek: prekladac, vystup na standardni chybovy */
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+    execvp(args[0], args);
+    _exit(127);
+  }
+
+  if (waitpid(pid, &status, 0) == -1 || !WIFEXITED(status) ||
+      WEXITSTATUS(status) != 0) {
+    return -1;
+  }
+
+  return 0;
+}
+
+
+/**
+ * Spusti aplikaci nsc a zmeri dobu behu.
+ * @param app Cesta k aplikaci nsc.
+ * @param workload Ukazatel na zatez.
+ * @return Doba behu v sekundach nebo zaporna hodnota pri chybe.
+ */
+double runWorkload(const char *app, TWorkload *workload)
+{
+  struct timespec start, end;
+  int fd[2];
+  int status;
+
+  if (pipe(fd) != 0)
+    return -1.0;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  pid_t pid = fork();
+  if (pid == -1)
+    return -1.0;
+
+  if (pid == 0) {  /* potomek: stdin z roury, stdout do /dev/null */
+    int null = open("/dev/null", O_WRONLY);
+
+    dup2(fd[0], STDIN_FILENO);
+    dup2(null, STDOUT_FILENO);
+    close(fd[0]);
+    close(fd[1]);
+    execl(app, app, (char *) NULL);
+    _exit(127);
+  }
+
+  close(fd[0]);
+  for (size_t written = 0; written < workload->length; ) {
+    ssize_t n = write(fd[1], workload->input + written,
+                      workload->length - written);
+    if (n <= 0)
+      break;
+    written += (size_t) n;
+  }
+  close(fd[1]);
+
+  if (waitpid(pid, &status, 0) == -1 || !WIFEXITED(status) ||
+      WEXITSTATUS(status) != 0) {
+    return -1.0;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  return (double) (end.tv_sec - start.tv_sec)
+         + (double) (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+
+/**
+ * Porovnani dvou hodnot typu double pro qsort.
+ */
+int compareDouble(const void *a, const void *b)
+{
+  double x = *(const double *) a;
+  double y = *(const double *) b;
+
+  return (x > y) - (x < y);
+}
+
+
+/**
+ * Zmeri median doby behu zateze.
+ * @return Median v sekundach nebo zaporna hodnota pri chybe.
+ */
+double measure(const char *app, TWorkload *workload)
+{
+  double times[REPEAT];
+
+  for (int i = 0; i < WARMUP; i++) {
+    if (runWorkload(app, workload) < 0.0)
+      return -1.0;
+  }
+
+  for (int i = 0; i < REPEAT; i++) {
+    times[i] = runWorkload(app, workload);
+    if (times[i] < 0.0)
+      return -1.0;
+  }
+
+  qsort(times, REPEAT, sizeof(double), compareDouble);
+
+  return times[REPEAT / 2];
+}
+
+
+
+/********************************** main() **********************************/
+
+int main(int argc, char *argv[])
+{
+  /** Zdrojovy soubor nsc.c, prekladac a jeho parametry */
+  if (argc < 3) {
+    printError(EPARAM);
+    return EPARAM;
+  }
+
+  srand((unsigned int) time(NULL));
+
+  for (size_t w = 0; w < WORKLOADS_COUNT; w++) {
+    if (generateWorkload(&workloads[w]) != 0) {
+      printError(EUNKNOWN);
+      return EUNKNOWN;
+    }
+  }
+
+  /** Mereni vsech velikosti bloku pro vsechny zateze */
+  double medians[BLOCK_SIZES_COUNT][WORKLOADS_COUNT];
+
+  for (size_t b = 0; b < BLOCK_SIZES_COUNT; b++) {
+    if (buildApp(argv + 1, argc - 1, blockSizes[b]) != 0) {
+      unlink(TUNE_APP);
+      printError(EBUILD);
+      return EBUILD;
+    }
+
+    fprintf(stderr, "NUM_BLOCK_SIZE=%-6u", blockSizes[b]);
+    for (size_t w = 0; w < WORKLOADS_COUNT; w++) {
+      medians[b][w] = measure(TUNE_APP, &workloads[w]);
+      if (medians[b][w] < 0.0) {
+        unlink(TUNE_APP);
+        printError(ERUN);
+        return ERUN;
+      }
+      fprintf(stderr, "  %u->%u: %.4fs", workloads[w].fromBase,
+              workloads[w].toBase, medians[b][w]);
+    }
+    fprintf(stderr, "\n");
+  }
+
+  unlink(TUNE_APP);
+
+  /**
+   * Vyber nejlepsi velikosti. Kazda zatez ma stejnou vahu, proto se casy
+   * vztahuji k vychozi velikosti bloku.
+   */
+  size_t best = DEFAULT_BLOCK_SIZE_INDEX;
+  double bestScore = (double) WORKLOADS_COUNT;
+
+  for (size_t b = 0; b < BLOCK_SIZES_COUNT; b++) {
+    double score = 0.0;
+    for (size_t w = 0; w < WORKLOADS_COUNT; w++)
+      score += medians[b][w] / medians[DEFAULT_BLOCK_SIZE_INDEX][w];
+
+    if (score < bestScore) {
+      bestScore = score;
+      best = b;
+    }
+  }
+
+  fprintf(stderr, "Selected NUM_BLOCK_SIZE=%u (%.1f%% of default time)\n",
+          blockSizes[best], 100.0 * bestScore / WORKLOADS_COUNT);
+
+  /** Vypis hlavickoveho souboru */
+  printf("/**\n");
+  printf(" * Soubor:    tune.h\n");
+  printf(" * Popis:     Prahy algoritmu namerene na tomto stroji pomoci "
+         "'make tune'.\n");
+  printf(" *            Soubor je generovany, neupravujte jej rucne.\n");
+  printf(" */\n\n");
+  printf("#ifndef NSC_TUNE_H\n");
+  printf("#define NSC_TUNE_H\n\n");
+  printf("#define NUM_BLOCK_SIZE %u  /**< velikost bloku cisel */\n\n",
+         blockSizes[best]);
+  printf("#endif\n");
+
+  for (size_t w = 0; w < WORKLOADS_COUNT; w++)
+    free(workloads[w].input);
+
+  return EOK;
+}